@@ -0,0 +1,577 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сжатия (contraction hierarchies) над ориентированным взвешенным графом.
+// Предобработка упорядочивает вершины по "важности" и добавляет рёбра-сокращения,
+// после чего запрос выполняется двунаправленным Дейкстрой только по рёбрам,
+// ведущим к более важным вершинам. Найденный путь разворачивается в рёбра исходного графа.
+template <typename Weight>
+class ContractionHierarchy {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    static constexpr EdgeId NO_CHILD = std::numeric_limits<EdgeId>::max();
+
+    // ребро иерархии: рёбра [0, edge_count) совпадают с рёбрами графа,
+    // остальные — сокращения, заменяющие пару рёбер first_child и second_child
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first_child = NO_CHILD;
+        EdgeId second_child = NO_CHILD;
+    };
+
+    explicit ContractionHierarchy(const Graph& graph);
+    // предобработка графа с изменившимися рёбрами в порядке сжатия прежней иерархии (её GetRanks):
+    // вершины не упорядочиваются заново, заново строятся только сокращения.
+    // Вершины, добавленные в конец графа после previous_rank, сжимаются первыми
+    ContractionHierarchy(const Graph& graph, const std::vector<size_t>& previous_rank);
+    // восстановление по результатам ранее выполненной предобработки (GetEdges, GetRanks)
+    ContractionHierarchy(const Graph& graph, std::vector<HierarchyEdge> edges, std::vector<size_t> rank);
+
+    struct RouteInfo {
+        Weight weight;
+        std::vector<EdgeId> edges;
+    };
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // поиск за один проход из любой вершины sources в любую вершину targets
+    std::optional<TerminalRoute<Weight>> BuildRoute(const std::vector<Terminal<Weight>>& sources,
+                                                    const std::vector<Terminal<Weight>>& targets) const;
+
+    // количество добавленных рёбер-сокращений
+    size_t GetShortcutCount() const;
+    const std::vector<HierarchyEdge>& GetEdges() const;
+    const std::vector<size_t>& GetRanks() const;
+
+private:
+    // ребро списка смежности: соседняя вершина и ребро иерархии
+    struct Arc {
+        VertexId vertex;
+        EdgeId edge;
+    };
+    using Arcs = std::vector<Arc>;
+
+    struct SearchData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+
+    static bool IsLess(const Weight& lhs, const Weight& rhs) {
+        return lhs < rhs;
+    }
+
+    void InitializeArcs();
+    void Contract();
+    void ContractInOrder(const std::vector<VertexId>& order);
+    void PrepareContraction();
+    void FinishContraction();
+    int ComputePriority(VertexId vertex, std::vector<std::pair<EdgeId, EdgeId>>* shortcuts);
+    void FindWitnesses(VertexId source, VertexId excluded, const Weight& max_weight);
+    void ContractVertex(VertexId vertex, const std::vector<std::pair<EdgeId, EdgeId>>& shortcuts);
+    void BuildSearchGraph();
+
+    struct SearchState {
+        explicit SearchState(size_t vertex_count)
+            : data(vertex_count)
+            , settled(vertex_count, false) {
+        }
+
+        std::vector<std::optional<SearchData>> data;
+        std::vector<bool> settled;
+        std::vector<std::pair<Weight, VertexId>> queue;
+    };
+
+    struct Meeting {
+        std::optional<Weight> weight;
+        VertexId vertex = 0;
+    };
+
+    void RunSearchStep(const std::vector<Arcs>& arcs, SearchState& state, const SearchState& other_state,
+                       Meeting& meeting) const;
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    // ограничение числа вершин, просматриваемых при поиске свидетеля
+    static constexpr size_t WITNESS_SETTLED_LIMIT = 100;
+
+    const Graph& graph_;
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> rank_;
+    size_t shortcut_count_ = 0;
+
+    // рабочие списки смежности непосредственно во время сжатия
+    std::vector<Arcs> out_arcs_;
+    std::vector<Arcs> in_arcs_;
+    std::vector<bool> contracted_;
+    std::vector<int> contracted_neighbours_;
+    std::vector<std::optional<Weight>> witness_weights_;
+    std::vector<VertexId> witness_touched_;
+    std::vector<std::pair<Weight, VertexId>> witness_queue_;
+
+    // итоговые "восходящие" списки: вперёд по рёбрам from -> to и назад по рёбрам to -> from
+    std::vector<Arcs> upward_arcs_;
+    std::vector<Arcs> downward_arcs_;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+{
+    InitializeArcs();
+    Contract();
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, const std::vector<size_t>& previous_rank)
+    : graph_(graph)
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    if (previous_rank.size() > vertex_count) {
+        throw std::invalid_argument("Hierarchy does not match the graph");
+    }
+    const size_t new_vertex_count = vertex_count - previous_rank.size();
+    std::vector<VertexId> order(vertex_count, vertex_count);
+    for (VertexId vertex = previous_rank.size(); vertex < vertex_count; ++vertex) {
+        order[vertex - previous_rank.size()] = vertex;
+    }
+    for (VertexId vertex = 0; vertex < previous_rank.size(); ++vertex) {
+        const size_t position = new_vertex_count + previous_rank[vertex];
+        if (previous_rank[vertex] >= previous_rank.size() || order[position] != vertex_count) {
+            throw std::invalid_argument("Hierarchy ranks are not a permutation");
+        }
+        order[position] = vertex;
+    }
+
+    InitializeArcs();
+    ContractInOrder(order);
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph, std::vector<HierarchyEdge> edges,
+                                                   std::vector<size_t> rank)
+    : graph_(graph)
+    , edges_(std::move(edges))
+    , rank_(std::move(rank))
+{
+    const size_t edge_count = graph.GetEdgeCount();
+    if (edges_.size() < edge_count || rank_.size() != graph.GetVertexCount()) {
+        throw std::invalid_argument("Hierarchy does not match the graph");
+    }
+    // сокращение всегда добавляется позже заменяемых им рёбер
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const HierarchyEdge& edge = edges_[edge_id];
+        if (edge.from >= rank_.size() || edge.to >= rank_.size()
+            || (edge.first_child != NO_CHILD && (edge.first_child >= edge_id || edge.second_child >= edge_id))) {
+            throw std::invalid_argument("Hierarchy edge is out of range");
+        }
+    }
+    shortcut_count_ = edges_.size() - edge_count;
+    BuildSearchGraph();
+}
+
+template <typename Weight>
+size_t ContractionHierarchy<Weight>::GetShortcutCount() const {
+    return shortcut_count_;
+}
+
+template <typename Weight>
+const std::vector<typename ContractionHierarchy<Weight>::HierarchyEdge>& ContractionHierarchy<Weight>::GetEdges() const {
+    return edges_;
+}
+
+template <typename Weight>
+const std::vector<size_t>& ContractionHierarchy<Weight>::GetRanks() const {
+    return rank_;
+}
+
+// рёбра графа становятся первыми рёбрами иерархии и рабочими списками смежности для сжатия
+template <typename Weight>
+void ContractionHierarchy<Weight>::InitializeArcs() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    out_arcs_.resize(vertex_count);
+    in_arcs_.resize(vertex_count);
+    edges_.reserve(graph_.GetEdgeCount());
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        const Edge<Weight> edge = graph_.GetEdge(edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        edges_.push_back({edge.from, edge.to, edge.weight});
+        if (edge.from != edge.to) {
+            out_arcs_[edge.from].push_back({edge.to, edge_id});
+            in_arcs_[edge.to].push_back({edge.from, edge_id});
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::PrepareContraction() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    contracted_.assign(vertex_count, false);
+    contracted_neighbours_.assign(vertex_count, 0);
+    witness_weights_.assign(vertex_count, std::nullopt);
+    rank_.assign(vertex_count, 0);
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::FinishContraction() {
+    out_arcs_.clear();
+    in_arcs_.clear();
+    contracted_.clear();
+    contracted_neighbours_.clear();
+    witness_weights_.clear();
+    witness_touched_.clear();
+    witness_queue_.clear();
+}
+
+// сжатие вершин в порядке возрастания приоритета с ленивым пересчётом
+template <typename Weight>
+void ContractionHierarchy<Weight>::Contract() {
+    PrepareContraction();
+    const size_t vertex_count = graph_.GetVertexCount();
+
+    using QueueItem = std::pair<int, VertexId>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        queue.emplace(ComputePriority(vertex, nullptr), vertex);
+    }
+
+    std::vector<std::pair<EdgeId, EdgeId>> shortcuts;
+    size_t next_rank = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+
+        shortcuts.clear();
+        const int priority = ComputePriority(vertex, &shortcuts);
+        if (!queue.empty() && priority > queue.top().first) {
+            queue.emplace(priority, vertex);
+            continue;
+        }
+        ContractVertex(vertex, shortcuts);
+        rank_[vertex] = next_rank++;
+    }
+    FinishContraction();
+}
+
+// сжатие в заданном порядке: приоритеты не вычисляются, свидетели ищутся один раз для каждой вершины
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractInOrder(const std::vector<VertexId>& order) {
+    PrepareContraction();
+    std::vector<std::pair<EdgeId, EdgeId>> shortcuts;
+    for (size_t rank = 0; rank < order.size(); ++rank) {
+        shortcuts.clear();
+        ComputePriority(order[rank], &shortcuts);
+        ContractVertex(order[rank], shortcuts);
+        rank_[order[rank]] = rank;
+    }
+    FinishContraction();
+}
+
+// приоритет вершины: разность рёбер плюс число уже сжатых соседей;
+// при переданном shortcuts заполняет пары (ребро входа, ребро выхода), требующие сокращения
+template <typename Weight>
+int ContractionHierarchy<Weight>::ComputePriority(VertexId vertex,
+                                                  std::vector<std::pair<EdgeId, EdgeId>>* shortcuts) {
+    int removed = 0;
+    int added = 0;
+    for (const Arc& in_arc : in_arcs_[vertex]) {
+        if (contracted_[in_arc.vertex]) {
+            continue;
+        }
+        ++removed;
+
+        std::optional<Weight> max_weight;
+        for (const Arc& out_arc : out_arcs_[vertex]) {
+            if (contracted_[out_arc.vertex] || out_arc.vertex == in_arc.vertex) {
+                continue;
+            }
+            const Weight weight = edges_[in_arc.edge].weight + edges_[out_arc.edge].weight;
+            if (!max_weight || IsLess(*max_weight, weight)) {
+                max_weight = weight;
+            }
+        }
+        if (!max_weight) {
+            continue;
+        }
+
+        FindWitnesses(in_arc.vertex, vertex, *max_weight);
+        for (const Arc& out_arc : out_arcs_[vertex]) {
+            if (contracted_[out_arc.vertex] || out_arc.vertex == in_arc.vertex) {
+                continue;
+            }
+            const Weight weight = edges_[in_arc.edge].weight + edges_[out_arc.edge].weight;
+            const auto& witness = witness_weights_[out_arc.vertex];
+            if (!witness || IsLess(weight, *witness)) {
+                ++added;
+                if (shortcuts) {
+                    shortcuts->emplace_back(in_arc.edge, out_arc.edge);
+                }
+            }
+        }
+    }
+    for (const Arc& out_arc : out_arcs_[vertex]) {
+        if (!contracted_[out_arc.vertex]) {
+            ++removed;
+        }
+    }
+    return added - removed + contracted_neighbours_[vertex];
+}
+
+// ограниченный Дейкстра из source в обход вершины excluded
+template <typename Weight>
+void ContractionHierarchy<Weight>::FindWitnesses(VertexId source, VertexId excluded, const Weight& max_weight) {
+    for (VertexId vertex : witness_touched_) {
+        witness_weights_[vertex].reset();
+    }
+    witness_touched_.clear();
+
+    auto greater = [](const std::pair<Weight, VertexId>& lhs, const std::pair<Weight, VertexId>& rhs) {
+        return IsLess(rhs.first, lhs.first);
+    };
+    auto& queue = witness_queue_;
+    queue.clear();
+
+    witness_weights_[source] = ZERO_WEIGHT;
+    witness_touched_.push_back(source);
+    queue.emplace_back(ZERO_WEIGHT, source);
+
+    size_t settled = 0;
+    while (!queue.empty() && settled < WITNESS_SETTLED_LIMIT) {
+        std::pop_heap(queue.begin(), queue.end(), greater);
+        const auto [weight, vertex] = queue.back();
+        queue.pop_back();
+        if (IsLess(*witness_weights_[vertex], weight)) {
+            continue;
+        }
+        if (IsLess(max_weight, weight)) {
+            break;
+        }
+        ++settled;
+        for (const Arc& arc : out_arcs_[vertex]) {
+            if (arc.vertex == excluded || contracted_[arc.vertex]) {
+                continue;
+            }
+            const Weight candidate = weight + edges_[arc.edge].weight;
+            auto& target = witness_weights_[arc.vertex];
+            if (!target) {
+                witness_touched_.push_back(arc.vertex);
+            }
+            if (!target || IsLess(candidate, *target)) {
+                target = candidate;
+                queue.emplace_back(candidate, arc.vertex);
+                std::push_heap(queue.begin(), queue.end(), greater);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::ContractVertex(VertexId vertex,
+                                                  const std::vector<std::pair<EdgeId, EdgeId>>& shortcuts) {
+    for (const auto& [first_edge, second_edge] : shortcuts) {
+        const VertexId from = edges_[first_edge].from;
+        const VertexId to = edges_[second_edge].to;
+        const EdgeId edge_id = edges_.size();
+        edges_.push_back({from, to, edges_[first_edge].weight + edges_[second_edge].weight, first_edge, second_edge});
+        out_arcs_[from].push_back({to, edge_id});
+        in_arcs_[to].push_back({from, edge_id});
+        ++shortcut_count_;
+    }
+
+    // убираем сжатую вершину из списков смежности соседей
+    auto erase_vertex = [vertex](Arcs& arcs) {
+        arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [vertex](const Arc& arc) {
+            return arc.vertex == vertex;
+        }), arcs.end());
+    };
+    contracted_[vertex] = true;
+    for (const Arc& arc : in_arcs_[vertex]) {
+        ++contracted_neighbours_[arc.vertex];
+        erase_vertex(out_arcs_[arc.vertex]);
+    }
+    for (const Arc& arc : out_arcs_[vertex]) {
+        ++contracted_neighbours_[arc.vertex];
+        erase_vertex(in_arcs_[arc.vertex]);
+    }
+    Arcs{}.swap(in_arcs_[vertex]);
+    Arcs{}.swap(out_arcs_[vertex]);
+}
+
+// оставляем для поиска только рёбра, ведущие к вершинам с большим рангом
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildSearchGraph() {
+    const size_t vertex_count = graph_.GetVertexCount();
+    upward_arcs_.assign(vertex_count, {});
+    downward_arcs_.assign(vertex_count, {});
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const HierarchyEdge& edge = edges_[edge_id];
+        if (rank_[edge.from] < rank_[edge.to]) {
+            upward_arcs_[edge.from].push_back({edge.to, edge_id});
+        }
+        else if (rank_[edge.to] < rank_[edge.from]) {
+            downward_arcs_[edge.to].push_back({edge.from, edge_id});
+        }
+    }
+}
+
+// один шаг поиска: извлечение ближайшей вершины и релаксация её рёбер
+template <typename Weight>
+void ContractionHierarchy<Weight>::RunSearchStep(const std::vector<Arcs>& arcs, SearchState& state,
+                                                 const SearchState& other_state, Meeting& meeting) const {
+    auto greater = [](const std::pair<Weight, VertexId>& lhs, const std::pair<Weight, VertexId>& rhs) {
+        return IsLess(rhs.first, lhs.first);
+    };
+    std::pop_heap(state.queue.begin(), state.queue.end(), greater);
+    const auto [weight, vertex] = state.queue.back();
+    state.queue.pop_back();
+    if (state.settled[vertex]) {
+        return;
+    }
+    state.settled[vertex] = true;
+
+    for (const Arc& arc : arcs[vertex]) {
+        const Weight candidate = weight + edges_[arc.edge].weight;
+        auto& target = state.data[arc.vertex];
+        if (target && !IsLess(candidate, target->weight)) {
+            continue;
+        }
+        target = SearchData{candidate, arc.edge};
+        state.queue.emplace_back(candidate, arc.vertex);
+        std::push_heap(state.queue.begin(), state.queue.end(), greater);
+
+        // вершина достигнута обоими направлениями поиска
+        if (const auto& other = other_state.data[arc.vertex]) {
+            const Weight total = candidate + other->weight;
+            if (!meeting.weight || IsLess(total, *meeting.weight)) {
+                meeting = {total, arc.vertex};
+            }
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    auto route = BuildRoute(std::vector<Terminal<Weight>>{{from, ZERO_WEIGHT}},
+                            std::vector<Terminal<Weight>>{{to, ZERO_WEIGHT}});
+    if (!route) {
+        return std::nullopt;
+    }
+    return RouteInfo{route->weight, std::move(route->edges)};
+}
+
+// начальные вершины равносильны рёбрам из фиктивного источника с наименьшим рангом,
+// конечные — рёбрам в фиктивный сток, поэтому условие остановки поиска не меняется
+template <typename Weight>
+std::optional<TerminalRoute<Weight>>
+ContractionHierarchy<Weight>::BuildRoute(const std::vector<Terminal<Weight>>& sources,
+                                         const std::vector<Terminal<Weight>>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    auto greater = [](const std::pair<Weight, VertexId>& lhs, const std::pair<Weight, VertexId>& rhs) {
+        return IsLess(rhs.first, lhs.first);
+    };
+    auto seed = [vertex_count, &greater](SearchState& state, const std::vector<Terminal<Weight>>& terminals) {
+        for (const Terminal<Weight>& terminal : terminals) {
+            if (terminal.vertex >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            auto& data = state.data[terminal.vertex];
+            if (!data || IsLess(terminal.weight, data->weight)) {
+                data = SearchData{terminal.weight, std::nullopt};
+                state.queue.emplace_back(terminal.weight, terminal.vertex);
+                std::push_heap(state.queue.begin(), state.queue.end(), greater);
+            }
+        }
+    };
+
+    SearchState forward(vertex_count);
+    SearchState backward(vertex_count);
+    seed(forward, sources);
+    seed(backward, targets);
+
+    Meeting meeting;
+    // вершина может быть одновременно начальной и конечной
+    for (const Terminal<Weight>& source : sources) {
+        if (const auto& other = backward.data[source.vertex]) {
+            const Weight total = forward.data[source.vertex]->weight + other->weight;
+            if (!meeting.weight || IsLess(total, *meeting.weight)) {
+                meeting = {total, source.vertex};
+            }
+        }
+    }
+    // направление поиска исчерпано, если его очередь пуста или минимальный вес не меньше лучшего найденного
+    auto is_done = [&meeting](const SearchState& state) {
+        return state.queue.empty() || (meeting.weight && !IsLess(state.queue.front().first, *meeting.weight));
+    };
+
+    while (!is_done(forward) || !is_done(backward)) {
+        if (!is_done(forward)) {
+            RunSearchStep(upward_arcs_, forward, backward, meeting);
+        }
+        if (!is_done(backward)) {
+            RunSearchStep(downward_arcs_, backward, forward, meeting);
+        }
+    }
+
+    if (!meeting.weight) {
+        return std::nullopt;
+    }
+
+    VertexId from = meeting.vertex;
+    std::vector<EdgeId> forward_edges;
+    while (forward.data[from]->prev_edge) {
+        const EdgeId edge_id = *forward.data[from]->prev_edge;
+        forward_edges.push_back(edge_id);
+        from = edges_[edge_id].from;
+    }
+    std::vector<EdgeId> edges;
+    for (auto it = forward_edges.rbegin(); it != forward_edges.rend(); ++it) {
+        UnpackEdge(*it, edges);
+    }
+    VertexId to = meeting.vertex;
+    while (backward.data[to]->prev_edge) {
+        const EdgeId edge_id = *backward.data[to]->prev_edge;
+        UnpackEdge(edge_id, edges);
+        to = edges_[edge_id].to;
+    }
+
+    return TerminalRoute<Weight>{from, to, *meeting.weight, std::move(edges)};
+}
+
+// разворачивание ребра-сокращения в последовательность рёбер исходного графа
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack{edge_id};
+    while (!stack.empty()) {
+        const HierarchyEdge& edge = edges_[stack.back()];
+        if (edge.first_child == NO_CHILD) {
+            edges.push_back(stack.back());
+            stack.pop_back();
+            continue;
+        }
+        stack.pop_back();
+        stack.push_back(edge.second_child);
+        stack.push_back(edge.first_child);
+    }
+}
+
+}  // namespace graph
\ No newline at end of file
@@ -2,8 +2,9 @@
 
 using namespace domain;
 
-Stop::Stop(std::string name, Coordinates coordinates)
-	: name_(name)
+Stop::Stop(StopId id, std::string_view name, Coordinates coordinates)
+	: id_(id)
+	, name_(name)
 	, coordinates_(coordinates)
 {
 }
@@ -11,8 +12,8 @@ bool Stop::operator==(const Stop& other) const {
 	return this->name_ == other.name_;
 }
 
-Bus::Bus(std::string name, std::vector<const Stop*> stops_of_bus, RouteType loop)
-	: name_(name), stops_of_bus_(stops_of_bus), loop_(loop)
+Bus::Bus(BusId id, std::string_view name, std::vector<StopId> stops_of_bus, RouteType loop)
+	: id_(id), name_(name), stops_of_bus_(std::move(stops_of_bus)), loop_(loop)
 {
 }
 bool Bus::operator==(const Bus& other) const {
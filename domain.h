@@ -1,42 +1,52 @@
 #pragma once
 #include "geo.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace domain {
 	using namespace geo;
 	using namespace std::literals;
 
+	// плотные идентификаторы остановок и маршрутов: номера в порядке добавления в каталог,
+	// по ним объекты и связанные с ними данные находятся индексированием массива
+	using StopId = uint32_t;
+	using BusId = uint32_t;
+
 	// список, отображающий зацикленность маршрута
 	enum class RouteType {
 		IS_LOOPED, // маршрут круговой
 		NOT_LOOPED // маршрут прямой
 	};
 
-	// структура остановки: имя(по стандарту "Error") - ширина - долгота
+	// структура остановки: идентификатор - имя - ширина - долгота.
+	// Имена остановок и маршрутов хранит пул строк каталога, объекты ссылаются на них через string_view
 	struct Stop {
 		Stop() = default;
-		Stop(std::string name, Coordinates coordinates);
+		Stop(StopId id, std::string_view name, Coordinates coordinates);
 
 		// для поиска остановки
 		bool operator==(const Stop& other) const;
 
-		std::string name_ = "Error"s;
+		StopId id_ = 0;
+		std::string_view name_;
 		Coordinates coordinates_;
 	};
 
-	// структура маршрута: номер автобуса(по стандарту "Error") - остановки - тип(прямой/кольцевой)
+	// структура маршрута: идентификатор - номер автобуса - остановки - тип(прямой/кольцевой)
 	struct Bus {
 		Bus() = default;
 		~Bus() = default;
-		Bus(std::string name, std::vector<const Stop*> stops_of_bus, RouteType loop);
+		Bus(BusId id, std::string_view name, std::vector<StopId> stops_of_bus, RouteType loop);
 
 		// для поиска маршрута
 		bool operator==(const Bus& other) const;
 
-		std::string name_ = "Error"s;
-		std::vector<const Stop*> stops_of_bus_;
+		BusId id_ = 0;
+		std::string_view name_;
+		std::vector<StopId> stops_of_bus_;
 		RouteType loop_;
 	};
 
@@ -1,8 +1,17 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__AVX__)
+#define GEO_SIMD_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GEO_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace geo {
 
     bool Coordinates::operator==(const Coordinates& other) const {
@@ -18,10 +27,220 @@ namespace geo {
             return 0;
         }
         static const double dr = M_PI / 180.;
-        static const int earth_radius = 6371000;
         return acos(sin(from.lat * dr) * sin(to.lat * dr)
             + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-            * earth_radius;
+            * EARTH_RADIUS;
+    }
+
+    namespace {
+        // расстояние по половине длины хорды; из-за округления она может немного превысить 1
+        double DistanceForHalfChord(double half_chord) {
+            return 2 * EARTH_RADIUS * std::asin(std::min(half_chord, 1.));
+        }
+
+#if defined(GEO_SIMD_AVX) || defined(GEO_SIMD_SSE2)
+        // арксинус на [0, 1] рациональными приближениями из библиотеки Cephes (погрешность порядка 1e-16):
+        // asin(x) = x + x^3 * P(x^2) / Q(x^2) при x <= 0.625,
+        // asin(x) = pi/2 - sqrt(2w) * (1 + w * R(w) / S(w)), w = 1 - x, иначе
+        constexpr double ASIN_P[] = { 4.253011369004428248960e-3, -6.019598008014123785661e-1, 5.444622390564711410273e0,
+            -1.626247967210700244449e1, 1.956261983317594739197e1, -8.198089802484824371615e0 };
+        constexpr double ASIN_Q[] = { 1., -1.474091372988853791896e1, 7.049610280856842141659e1,
+            -1.471791292232726029859e2, 1.395105614657485689735e2, -4.918853881490881290097e1 };
+        constexpr double ASIN_R[] = { 2.967721961301243206100e-3, -5.634242780008963776856e-1, 6.968710824104713396794e0,
+            -2.556901049652824852289e1, 2.853665548261061424989e1 };
+        constexpr double ASIN_S[] = { 1., -2.194779531642920639778e1, 1.470656354026814941758e2,
+            -3.838770957603691357202e2, 3.424398657913078477438e2 };
+        constexpr double ASIN_SPLIT = 0.625;
+        constexpr double PI_4 = 7.85398163397448309616e-1;
+        // младшие разряды pi/4, не поместившиеся в PI_4
+        constexpr double PI_4_LOW = 6.123233995736765886130e-17;
+#endif
+
+#if defined(GEO_SIMD_AVX)
+        // четыре значения double в регистре AVX
+        struct Lanes {
+            using Value = __m256d;
+            static constexpr size_t SIZE = 4;
+
+            static Value Set(double value) { return _mm256_set1_pd(value); }
+            // значения загружаются по одному: инструкция выборки AVX2 на процессорах с защитой от Downfall
+            // медленнее четырёх отдельных загрузок
+            static Value Gather(const double* base, const uint32_t* index) {
+                return _mm256_set_pd(base[index[3]], base[index[2]], base[index[1]], base[index[0]]);
+            }
+            static void Store(double* output, Value value) { _mm256_storeu_pd(output, value); }
+            static Value Add(Value lhs, Value rhs) { return _mm256_add_pd(lhs, rhs); }
+            static Value Sub(Value lhs, Value rhs) { return _mm256_sub_pd(lhs, rhs); }
+            static Value Mul(Value lhs, Value rhs) { return _mm256_mul_pd(lhs, rhs); }
+            static Value Div(Value lhs, Value rhs) { return _mm256_div_pd(lhs, rhs); }
+            static Value Min(Value lhs, Value rhs) { return _mm256_min_pd(lhs, rhs); }
+            static Value Sqrt(Value value) { return _mm256_sqrt_pd(value); }
+            static Value Greater(Value lhs, Value rhs) { return _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ); }
+            static bool Any(Value mask) { return _mm256_movemask_pd(mask) != 0; }
+            // по маске берётся if_set, иначе otherwise
+            static Value Select(Value mask, Value if_set, Value otherwise) { return _mm256_blendv_pd(otherwise, if_set, mask); }
+        };
+#elif defined(GEO_SIMD_SSE2)
+        // два значения double в регистре SSE; выборки по индексам в SSE2 нет, значения загружаются по одному
+        struct Lanes {
+            using Value = __m128d;
+            static constexpr size_t SIZE = 2;
+
+            static Value Set(double value) { return _mm_set1_pd(value); }
+            static Value Gather(const double* base, const uint32_t* index) { return _mm_set_pd(base[index[1]], base[index[0]]); }
+            static void Store(double* output, Value value) { _mm_storeu_pd(output, value); }
+            static Value Add(Value lhs, Value rhs) { return _mm_add_pd(lhs, rhs); }
+            static Value Sub(Value lhs, Value rhs) { return _mm_sub_pd(lhs, rhs); }
+            static Value Mul(Value lhs, Value rhs) { return _mm_mul_pd(lhs, rhs); }
+            static Value Div(Value lhs, Value rhs) { return _mm_div_pd(lhs, rhs); }
+            static Value Min(Value lhs, Value rhs) { return _mm_min_pd(lhs, rhs); }
+            static Value Sqrt(Value value) { return _mm_sqrt_pd(value); }
+            static Value Greater(Value lhs, Value rhs) { return _mm_cmpgt_pd(lhs, rhs); }
+            static bool Any(Value mask) { return _mm_movemask_pd(mask) != 0; }
+            static Value Select(Value mask, Value if_set, Value otherwise) {
+                return _mm_or_pd(_mm_and_pd(mask, if_set), _mm_andnot_pd(mask, otherwise));
+            }
+        };
+#endif
+
+#if defined(GEO_SIMD_AVX) || defined(GEO_SIMD_SSE2)
+        // многочлен по схеме Горнера, коэффициенты от старшего к младшему
+        template <size_t N>
+        Lanes::Value Polynomial(Lanes::Value x, const double (&coefficients)[N]) {
+            Lanes::Value result = Lanes::Set(coefficients[0]);
+            for (size_t i = 1; i < N; ++i) {
+                result = Lanes::Add(Lanes::Mul(result, x), Lanes::Set(coefficients[i]));
+            }
+            return result;
+        }
+
+        // вторая ветвь приближения нужна только для дуг длиннее ~8600 км; если такие есть среди элементов,
+        // считаются обе ветви и нужная выбирается по маске
+        Lanes::Value Asin(Lanes::Value x) {
+            const Lanes::Value x2 = Lanes::Mul(x, x);
+            const Lanes::Value small = Lanes::Add(x, Lanes::Mul(Lanes::Mul(x, x2),
+                Lanes::Div(Polynomial(x2, ASIN_P), Polynomial(x2, ASIN_Q))));
+            const Lanes::Value is_large = Lanes::Greater(x, Lanes::Set(ASIN_SPLIT));
+            if (!Lanes::Any(is_large)) {
+                return small;
+            }
+
+            const Lanes::Value w = Lanes::Sub(Lanes::Set(1.), x);
+            const Lanes::Value p = Lanes::Div(Lanes::Mul(w, Polynomial(w, ASIN_R)), Polynomial(w, ASIN_S));
+            const Lanes::Value root = Lanes::Sqrt(Lanes::Add(w, w));
+            const Lanes::Value correction = Lanes::Sub(Lanes::Mul(root, p), Lanes::Set(PI_4_LOW));
+            const Lanes::Value large = Lanes::Add(Lanes::Sub(Lanes::Sub(Lanes::Set(PI_4), root), correction), Lanes::Set(PI_4));
+
+            return Lanes::Select(is_large, large, small);
+        }
+#endif
+    } // namespace
+
+    CoordinateArrays::CoordinateArrays(const std::vector<Coordinates>& points) {
+        lats_.reserve(points.size());
+        lngs_.reserve(points.size());
+        for (Coordinates point : points) {
+            Add(point);
+        }
+    }
+
+    void CoordinateArrays::Add(Coordinates point) {
+        lats_.push_back(point.lat);
+        lngs_.push_back(point.lng);
+    }
+
+    void CoordinateArrays::Set(uint32_t index, Coordinates point) {
+        lats_.at(index) = point.lat;
+        lngs_.at(index) = point.lng;
+    }
+
+    size_t CoordinateArrays::GetSize() const {
+        return lats_.size();
+    }
+
+    Coordinates CoordinateArrays::Get(uint32_t index) const {
+        return { lats_[index], lngs_[index] };
+    }
+
+    const std::vector<double>& CoordinateArrays::GetLats() const {
+        return lats_;
+    }
+
+    const std::vector<double>& CoordinateArrays::GetLngs() const {
+        return lngs_;
+    }
+
+    BoundingBox CoordinateArrays::ComputeBoundingBox(const uint32_t* indices, size_t count) const {
+        BoundingBox box{ Get(indices[0]), Get(indices[0]) };
+        for (size_t i = 1; i < count; ++i) {
+            const double lat = lats_[indices[i]];
+            const double lng = lngs_[indices[i]];
+            box.min.lat = std::min(box.min.lat, lat);
+            box.min.lng = std::min(box.min.lng, lng);
+            box.max.lat = std::max(box.max.lat, lat);
+            box.max.lng = std::max(box.max.lng, lng);
+        }
+        return box;
+    }
+
+    double CoordinateArrays::ComputeDistance(uint32_t from, uint32_t to) const {
+        return geo::ComputeDistance(Get(from), Get(to));
+    }
+
+    SpherePoints::SpherePoints(const std::vector<Coordinates>& points) {
+        x_.reserve(points.size());
+        y_.reserve(points.size());
+        z_.reserve(points.size());
+        for (Coordinates point : points) {
+            Add(point);
+        }
+    }
+
+    void SpherePoints::Add(Coordinates point) {
+        x_.push_back(0);
+        y_.push_back(0);
+        z_.push_back(0);
+        Set(static_cast<uint32_t>(x_.size() - 1), point);
+    }
+
+    void SpherePoints::Set(uint32_t index, Coordinates point) {
+        static const double dr = M_PI / 180.;
+        const double lat = point.lat * dr;
+        const double lng = point.lng * dr;
+        x_.at(index) = std::cos(lat) * std::cos(lng);
+        y_.at(index) = std::cos(lat) * std::sin(lng);
+        z_.at(index) = std::sin(lat);
+    }
+
+    size_t SpherePoints::GetSize() const {
+        return x_.size();
+    }
+
+    double SpherePoints::ComputeDistance(uint32_t from, uint32_t to) const {
+        const double dx = x_[from] - x_[to];
+        const double dy = y_[from] - y_[to];
+        const double dz = z_[from] - z_[to];
+        return DistanceForHalfChord(std::sqrt(dx * dx + dy * dy + dz * dz) / 2);
+    }
+
+    void SpherePoints::ComputeDistances(const uint32_t* from, const uint32_t* to, size_t count, double* distances) const {
+        size_t i = 0;
+#if defined(GEO_SIMD_AVX) || defined(GEO_SIMD_SSE2)
+        const Lanes::Value half = Lanes::Set(0.5);
+        const Lanes::Value one = Lanes::Set(1.);
+        const Lanes::Value diameter = Lanes::Set(2 * EARTH_RADIUS);
+        for (; i + Lanes::SIZE <= count; i += Lanes::SIZE) {
+            const Lanes::Value dx = Lanes::Sub(Lanes::Gather(x_.data(), from + i), Lanes::Gather(x_.data(), to + i));
+            const Lanes::Value dy = Lanes::Sub(Lanes::Gather(y_.data(), from + i), Lanes::Gather(y_.data(), to + i));
+            const Lanes::Value dz = Lanes::Sub(Lanes::Gather(z_.data(), from + i), Lanes::Gather(z_.data(), to + i));
+            const Lanes::Value squared_chord = Lanes::Add(Lanes::Add(Lanes::Mul(dx, dx), Lanes::Mul(dy, dy)), Lanes::Mul(dz, dz));
+            const Lanes::Value half_chord = Lanes::Min(Lanes::Mul(Lanes::Sqrt(squared_chord), half), one);
+            Lanes::Store(distances + i, Lanes::Mul(diameter, Asin(half_chord)));
+        }
+#endif
+        for (; i < count; ++i) {
+            distances[i] = ComputeDistance(from[i], to[i]);
+        }
     }
 
 }  // namespace geo
\ No newline at end of file
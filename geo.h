@@ -1,7 +1,14 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace geo {
 
+    // радиус Земли в метрах
+    inline constexpr double EARTH_RADIUS = 6371000;
+
     struct Coordinates {
         double lat; // Широта
         double lng; // Долгота
@@ -11,4 +18,63 @@ namespace geo {
 
     double ComputeDistance(Coordinates from, Coordinates to);
 
+    // прямоугольник, охватывающий точки
+    struct BoundingBox {
+        Coordinates min; // наименьшие широта и долгота
+        Coordinates max; // наибольшие широта и долгота
+    };
+
+    // Широты и долготы точек раздельными непрерывными массивами (индекс — номер точки в порядке добавления).
+    // Проходы по одной из координат читают подряд только её значения
+    class CoordinateArrays {
+    public:
+        CoordinateArrays() = default;
+        explicit CoordinateArrays(const std::vector<Coordinates>& points);
+
+        // добавление точки; её индекс — число точек до неё
+        void Add(Coordinates point);
+        void Set(uint32_t index, Coordinates point);
+        size_t GetSize() const;
+        Coordinates Get(uint32_t index) const;
+
+        // lats[i], lngs[i] — широта и долгота точки i
+        const std::vector<double>& GetLats() const;
+        const std::vector<double>& GetLngs() const;
+
+        // прямоугольник, охватывающий точки indices[0..count), за один проход; count > 0
+        BoundingBox ComputeBoundingBox(const uint32_t* indices, size_t count) const;
+        double ComputeDistance(uint32_t from, uint32_t to) const;
+
+    private:
+        std::vector<double> lats_;
+        std::vector<double> lngs_;
+    };
+
+    // Точки на единичной сфере раздельными массивами декартовых координат.
+    // Синусы и косинусы широты и долготы считаются один раз при добавлении точки,
+    // расстояние между точками — по длине хорды: 2 * R * asin(|a - b| / 2).
+    // Это та же дуга большого круга, что и в ComputeDistance, но без потери точности на коротких дугах:
+    // у acos около 1 относительная погрешность доходит до 1e-2 на дугах около 100 м, здесь — не больше 1e-8
+    class SpherePoints {
+    public:
+        SpherePoints() = default;
+        explicit SpherePoints(const std::vector<Coordinates>& points);
+
+        // добавление точки; её индекс — число точек до неё
+        void Add(Coordinates point);
+        void Set(uint32_t index, Coordinates point);
+        size_t GetSize() const;
+
+        double ComputeDistance(uint32_t from, uint32_t to) const;
+        // distances[i] — расстояние между точками from[i] и to[i], i < count.
+        // Пакет обрабатывается векторными инструкциями (AVX или SSE2, если они включены при компиляции),
+        // без них — по одной паре
+        void ComputeDistances(const uint32_t* from, const uint32_t* to, size_t count, double* distances) const;
+
+    private:
+        std::vector<double> x_;
+        std::vector<double> y_;
+        std::vector<double> z_;
+    };
+
 }  // namespace geo
\ No newline at end of file
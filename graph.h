@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -17,6 +18,27 @@ struct Edge {
     Weight weight;
 };
 
+// начальная (конечная) вершина поиска из нескольких вершин в несколько
+// и вес пути от точки отправления до неё (от неё до точки назначения)
+template <typename Weight>
+struct Terminal {
+    VertexId vertex;
+    Weight weight;
+};
+
+// путь поиска из нескольких вершин в несколько: выбранные начальная и конечная вершины,
+// вес с учётом весов обеих и рёбра графа между ними
+template <typename Weight>
+struct TerminalRoute {
+    VertexId from;
+    VertexId to;
+    Weight weight;
+    std::vector<EdgeId> edges;
+};
+
+// Атрибуты рёбер хранятся раздельными массивами (from, to, weight).
+// После Freeze списки инцидентности упаковываются в формат CSR: рёбра каждой вершины
+// лежат подряд в одном массиве, границы задаются массивом смещений.
 template <typename Weight>
 class DirectedWeightedGraph {
 private:
@@ -28,47 +50,113 @@ public:
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // упаковка списков инцидентности в CSR; после вызова добавлять рёбра нельзя
+    void Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
+    VertexId GetEdgeFrom(EdgeId edge_id) const;
+    VertexId GetEdgeTo(EdgeId edge_id) const;
+    const Weight& GetEdgeWeight(EdgeId edge_id) const;
+    // замена веса ребра; концы ребра не меняются, поэтому это допустимо и после Freeze
+    void SetEdgeWeight(EdgeId edge_id, const Weight& weight);
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
 private:
-    std::vector<Edge<Weight>> edges_;
+    size_t vertex_count_ = 0;
+    std::vector<VertexId> edges_from_;
+    std::vector<VertexId> edges_to_;
+    std::vector<Weight> edges_weight_;
+
+    // списки инцидентности до заморозки
     std::vector<IncidenceList> incidence_lists_;
+    // CSR после заморозки: рёбра вершины v — incident_edges_[offsets_[v], offsets_[v + 1])
+    std::vector<size_t> offsets_;
+    IncidenceList incident_edges_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count)
+    , incidence_lists_(vertex_count) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
-    edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
+    if (IsFrozen()) {
+        throw std::logic_error("Graph is frozen");
+    }
+    const EdgeId id = edges_weight_.size();
     incidence_lists_.at(edge.from).push_back(id);
+    edges_from_.push_back(edge.from);
+    edges_to_.push_back(edge.to);
+    edges_weight_.push_back(edge.weight);
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (IsFrozen()) {
+        return;
+    }
+    offsets_.reserve(vertex_count_ + 1);
+    incident_edges_.reserve(edges_weight_.size());
+    offsets_.push_back(0);
+    for (const IncidenceList& incidence_list : incidence_lists_) {
+        incident_edges_.insert(incident_edges_.end(), incidence_list.begin(), incidence_list.end());
+        offsets_.push_back(incident_edges_.size());
+    }
+    std::vector<IncidenceList>{}.swap(incidence_lists_);
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return !offsets_.empty();
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return edges_weight_.size();
+}
+
+template <typename Weight>
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    return {edges_from_.at(edge_id), edges_to_.at(edge_id), edges_weight_.at(edge_id)};
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeFrom(EdgeId edge_id) const {
+    return edges_from_[edge_id];
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::GetEdgeTo(EdgeId edge_id) const {
+    return edges_to_[edge_id];
+}
+
+template <typename Weight>
+const Weight& DirectedWeightedGraph<Weight>::GetEdgeWeight(EdgeId edge_id) const {
+    return edges_weight_[edge_id];
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, const Weight& weight) {
+    edges_weight_.at(edge_id) = weight;
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (!IsFrozen()) {
+        return ranges::AsRange(incidence_lists_.at(vertex));
+    }
+    return {incident_edges_.begin() + offsets_.at(vertex), incident_edges_.begin() + offsets_.at(vertex + 1)};
 }
 }  // namespace graph
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include "json.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
 
 using namespace std;
 
@@ -8,188 +15,328 @@ namespace json {
 
     namespace {
 
-        Node LoadNode(istream& input);
+        // Однопроходный разбор JSON из непрерывного буфера.
+        // Разобранные значения передаются обработчику событий: для построения дерева Node
+        // используется TreeHandler, для потоковой обработки — любой наследник Handler.
+        // Строки без escape-последовательностей копируются целиком (поиск кавычки через memchr),
+        // числа разбираются std::from_chars без промежуточных строк.
+        template <typename EventHandler>
+        class Parser {
+        public:
+            Parser(std::string_view input, EventHandler& handler)
+                : input_(input)
+                , handler_(handler) {
+            }
 
-        Node LoadArray(istream& input) {
-            Array result;
+            void ParseValue() {
+                SkipSpaces();
+                if (pos_ == input_.size()) {
+                    throw ParsingError("Unexpected end of input"s);
+                }
+                const char c = input_[pos_];
+                if (c == '[') {
+                    ++pos_;
+                    ParseArray();
+                }
+                else if (c == '{') {
+                    ++pos_;
+                    ParseDict();
+                }
+                else if (c == '"') {
+                    ++pos_;
+                    handler_.String(LoadString());
+                }
+                else if (c == 't' || c == 'f' || c == 'n') {
+                    LoadConst();
+                }
+                else {
+                    LoadNumber();
+                }
+            }
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+            void ParseArray() {
+                handler_.StartArray();
+                if (PeekSignificant() == ']') {
+                    ++pos_;
+                    handler_.EndArray();
+                    return;
+                }
+                while (true) {
+                    ParseValue();
+                    const char c = PeekSignificant();
+                    ++pos_;
+                    if (c == ']') {
+                        break;
+                    }
+                    if (c != ',') {
+                        throw ParsingError("Failed to load Array"s);
+                    }
                 }
-                result.push_back(LoadNode(input));
+                handler_.EndArray();
             }
 
-            return Node(move(result));
-        }
+            void ParseDict() {
+                handler_.StartDict();
+                if (PeekSignificant() == '}') {
+                    ++pos_;
+                    handler_.EndDict();
+                    return;
+                }
+                while (true) {
+                    if (PeekSignificant() != '"') {
+                        throw ParsingError("Failed to load Dict key"s);
+                    }
+                    ++pos_;
+                    handler_.Key(LoadString());
+                    if (PeekSignificant() != ':') {
+                        throw ParsingError("Failed to load Dict"s);
+                    }
+                    ++pos_;
+                    ParseValue();
 
-        Node LoadString(istream& input) {
-            std::string json_line;
-            for (char c; input.get(c) && c != '\"';) {
-                if (c == '\\') {
-                    input.get(c);
-                    if (!input.eof()) {
-                        if (c == 'n') {
-                            json_line += '\n';
-                            continue;
-                        }
-                        else if (c == 'r') {
-                            json_line += '\r';
-                            continue;
-                        }
-                        else if (c == 't') {
-                            json_line += '\t';
-                            continue;
-                        }
-                        else if (c == '\"' || c == '\\') {
-                            json_line += c;
-                            continue;
-                        }
+                    const char c = PeekSignificant();
+                    ++pos_;
+                    if (c == '}') {
+                        break;
+                    }
+                    if (c != ',') {
+                        throw ParsingError("Failed to load Dict"s);
                     }
                 }
-                else {
-                    json_line += c;
+                handler_.EndDict();
+            }
+
+        private:
+            std::string_view input_;
+            EventHandler& handler_;
+            size_t pos_ = 0;
+            // строка с escape-последовательностями после их замены
+            string unescaped_;
+
+            void SkipSpaces() {
+                while (pos_ < input_.size()) {
+                    const char c = input_[pos_];
+                    if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && c != '\v' && c != '\f') {
+                        break;
+                    }
+                    ++pos_;
                 }
             }
-            if (input.eof())  throw ParsingError("Failed to load String"s);
-            return Node(move(json_line));
-        }
 
-        Node LoadDict(istream& input) {
-            Dict result;
+            // следующий значимый символ (0 в конце ввода)
+            char PeekSignificant() {
+                SkipSpaces();
+                return pos_ < input_.size() ? input_[pos_] : '\0';
+            }
 
-            for (char c; input >> c && c != '}';) {
-                if (c == ',') {
-                    input >> c;
+            // разбор строки, открывающая кавычка уже прочитана.
+            // Строка без escape-последовательностей возвращается как участок входного буфера,
+            // иначе собирается в unescaped_ и действительна до следующего вызова
+            std::string_view LoadString() {
+                unescaped_.clear();
+                bool escaped = false;
+                while (true) {
+                    const char* begin = input_.data() + pos_;
+                    const size_t rest = input_.size() - pos_;
+                    const char* quote = static_cast<const char*>(memchr(begin, '"', rest));
+                    if (quote == nullptr) {
+                        throw ParsingError("Failed to load String"s);
+                    }
+                    const char* backslash = static_cast<const char*>(memchr(begin, '\\', quote - begin));
+                    if (backslash == nullptr) {
+                        pos_ += quote - begin + 1;
+                        if (!escaped) {
+                            return std::string_view(begin, quote - begin);
+                        }
+                        unescaped_.append(begin, quote);
+                        return unescaped_;
+                    }
+                    escaped = true;
+                    unescaped_.append(begin, backslash);
+                    pos_ += backslash - begin + 1;
+                    if (pos_ == input_.size()) {
+                        throw ParsingError("Failed to load String"s);
+                    }
+                    LoadEscape(unescaped_);
                 }
+            }
 
-                string key = LoadString(input).AsString();
-                input >> c;
-                result.insert({ move(key), LoadNode(input) });
+            // разбор escape-последовательности, обратная косая черта уже прочитана
+            void LoadEscape(string& json_line) {
+                const char c = input_[pos_++];
+                switch (c) {
+                    case 'n':
+                        json_line += '\n';
+                        break;
+                    case 'r':
+                        json_line += '\r';
+                        break;
+                    case 't':
+                        json_line += '\t';
+                        break;
+                    case 'b':
+                        json_line += '\b';
+                        break;
+                    case 'f':
+                        json_line += '\f';
+                        break;
+                    case '"':
+                    case '\\':
+                    case '/':
+                        json_line += c;
+                        break;
+                    case 'u':
+                        LoadUnicodeEscape(json_line);
+                        break;
+                    default:
+                        throw ParsingError("Unrecognized escape sequence \\"s + c);
+                }
             }
 
-            return Node(move(result));
-        }
+            // \uXXXX (с суррогатными парами) записывается в UTF-8
+            void LoadUnicodeEscape(string& json_line) {
+                uint32_t code = ReadHex4();
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    if (input_.substr(pos_, 2) != "\\u"sv) {
+                        throw ParsingError("Invalid surrogate pair"s);
+                    }
+                    pos_ += 2;
+                    const uint32_t low = ReadHex4();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        throw ParsingError("Invalid surrogate pair"s);
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                if (code < 0x80) {
+                    json_line += static_cast<char>(code);
+                }
+                else if (code < 0x800) {
+                    json_line += static_cast<char>(0xC0 | (code >> 6));
+                    json_line += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000) {
+                    json_line += static_cast<char>(0xE0 | (code >> 12));
+                    json_line += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    json_line += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else {
+                    json_line += static_cast<char>(0xF0 | (code >> 18));
+                    json_line += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    json_line += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    json_line += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
 
-        using Number = std::variant<int, double>;
+            uint32_t ReadHex4() {
+                if (input_.size() - pos_ < 4) {
+                    throw ParsingError("Failed to load \\u escape"s);
+                }
+                uint32_t code = 0;
+                const char* begin = input_.data() + pos_;
+                auto [ptr, ec] = from_chars(begin, begin + 4, code, 16);
+                if (ec != errc() || ptr != begin + 4) {
+                    throw ParsingError("Failed to load \\u escape"s);
+                }
+                pos_ += 4;
+                return code;
+            }
 
-        Node LoadNumber(std::istream& input) {
-            using namespace std::literals;
+            void LoadNumber() {
+                const size_t start = pos_;
 
-            std::string parsed_num;
+                auto is_digit = [this]() {
+                    return pos_ < input_.size() && input_[pos_] >= '0' && input_[pos_] <= '9';
+                };
+                // Считывает одну или более цифр
+                auto read_digits = [this, &is_digit] {
+                    if (!is_digit()) {
+                        throw ParsingError("A digit is expected"s);
+                    }
+                    while (is_digit()) {
+                        ++pos_;
+                    }
+                };
+                auto peek = [this]() {
+                    return pos_ < input_.size() ? input_[pos_] : '\0';
+                };
 
-            // Считывает в parsed_num очередной символ из input
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
+                if (peek() == '-') {
+                    ++pos_;
                 }
-            };
-
-            // Считывает одну или более цифр в parsed_num из input
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
-                    throw ParsingError("A digit is expected"s);
+                // Парсим целую часть числа
+                if (peek() == '0') {
+                    ++pos_;
+                    // После 0 в JSON не могут идти другие цифры
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                else {
+                    read_digits();
                 }
-            };
-
-            if (input.peek() == '-') {
-                read_char();
-            }
-            // Парсим целую часть числа
-            if (input.peek() == '0') {
-                read_char();
-                // После 0 в JSON не могут идти другие цифры
-            }
-            else {
-                read_digits();
-            }
 
-            bool is_int = true;
-            // Парсим дробную часть числа
-            if (input.peek() == '.') {
-                read_char();
-                read_digits();
-                is_int = false;
-            }
+                bool is_int = true;
+                // Парсим дробную часть числа
+                if (peek() == '.') {
+                    ++pos_;
+                    read_digits();
+                    is_int = false;
+                }
 
-            // Парсим экспоненциальную часть числа
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+                // Парсим экспоненциальную часть числа
+                if (char ch = peek(); ch == 'e' || ch == 'E') {
+                    ++pos_;
+                    if (ch = peek(); ch == '+' || ch == '-') {
+                        ++pos_;
+                    }
+                    read_digits();
+                    is_int = false;
                 }
-                read_digits();
-                is_int = false;
-            }
 
-            try {
+                const char* begin = input_.data() + start;
+                const char* end = input_.data() + pos_;
                 if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return std::stoi(parsed_num);
-                    }
-                    catch (...) {
-                        // В случае неудачи, например, при переполнении,
-                        // код ниже попробует преобразовать строку в double
+                    // Сначала пробуем преобразовать в int; при переполнении число читается как double
+                    int value = 0;
+                    if (auto [ptr, ec] = from_chars(begin, end, value); ec == errc() && ptr == end) {
+                        handler_.Int(value);
+                        return;
                     }
                 }
-                return std::stod(parsed_num);
-            }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-            }
-        }
-
-        Node LoadConst(istream& input) {
-            string result;
-            while (isalpha(input.peek())) {
-                result.push_back(static_cast<char>(input.get()));
-            }
-            if (result == "true"s) {
-                return Node(true);
-            }
-            else if (result == "false"s) {
-                return Node(false);
-            }
-            else if (result == "null"s) {
-                return Node();
-            }
-            else {
-                throw ParsingError("Failed to load Bool"s);
+                double value = 0;
+                if (auto [ptr, ec] = from_chars(begin, end, value); ec == errc() && ptr == end) {
+                    handler_.Double(value);
+                    return;
+                }
+                throw ParsingError("Failed to convert "s + string(begin, end) + " to number"s);
             }
-        }
-
-        Node LoadNode(istream& input) {
-            char c;
-            input >> c;
 
-            if (c == '[') {
-                input >> c;
-                if (input.eof()) throw ParsingError("Failed to load Array"s);
-                input.unget();
-                return LoadArray(input);
-            }
-            else if (c == '{') {
-                input >> c;
-                if (input.eof()) throw ParsingError("Failed to load Dict"s);
-                input.unget();
-                return LoadDict(input);
-            }
-            else if (c == '"') {
-                return LoadString(input);
-            }
-            else if (c == 't' || c == 'f' || c == 'n') {
-                input.unget();
-                return LoadConst(input);
+            void LoadConst() {
+                const size_t start = pos_;
+                while (pos_ < input_.size() && isalpha(static_cast<unsigned char>(input_[pos_]))) {
+                    ++pos_;
+                }
+                const std::string_view result = input_.substr(start, pos_ - start);
+                if (result == "true"sv) {
+                    handler_.Bool(true);
+                }
+                else if (result == "false"sv) {
+                    handler_.Bool(false);
+                }
+                else if (result == "null"sv) {
+                    handler_.Null();
+                }
+                else {
+                    throw ParsingError("Failed to load Bool"s);
+                }
             }
-            else {
-                input.unget();
-                return LoadNumber(input);
+        };
+
+        // чтение всего потока в непрерывный буфер
+        string ReadAll(istream& input) {
+            string buffer;
+            char chunk[1 << 16];
+            while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+                buffer.append(chunk, static_cast<size_t>(input.gcount()));
             }
+            return buffer;
         }
 
     }  // namespace
@@ -209,7 +356,7 @@ namespace json {
         return std::holds_alternative<double>(GetNode());
     }
     bool Node::IsString() const {
-        return std::holds_alternative<std::string>(GetNode());
+        return std::holds_alternative<String>(GetNode());
     }
     bool Node::IsBool() const {
         return std::holds_alternative<bool>(GetNode());
@@ -250,11 +397,27 @@ namespace json {
         }
         return std::get<Dict>(GetNode());
     }
-    const std::string& Node::AsString() const {
+    const String& Node::AsString() const {
         if (!IsString()) {
             throw std::invalid_argument("No matching variable type");
         }
-        return std::get<string>(GetNode());
+        return std::get<String>(GetNode());
+    }
+
+    Node::Node(std::string_view value)
+        : Variable(String(value)) {
+    }
+
+    const Node& Dict::at(std::string_view key) const {
+        const auto it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("No key "s + string(key));
+        }
+        return it->second;
+    }
+
+    Node& Dict::at(std::string_view key) {
+        return const_cast<Node&>(static_cast<const Dict&>(*this).at(key));
     }
 
     //////////////////////////////////////
@@ -262,6 +425,19 @@ namespace json {
         : root_(move(root)) {
     }
 
+    Document::Document(Node root, std::unique_ptr<std::pmr::monotonic_buffer_resource> arena)
+        : arena_(move(arena))
+        , root_(move(root)) {
+    }
+
+    // дерево в арене не обходится: его содержимое переносится в узел, выделенный в той же арене
+    // и не разрушаемый явно, а память всех узлов освобождается вместе с ареной
+    Document::~Document() {
+        if (arena_) {
+            new (arena_->allocate(sizeof(Node), alignof(Node))) Node(move(root_));
+        }
+    }
+
     const Node& Document::GetRoot() const {
         return root_;
     }
@@ -289,7 +465,7 @@ namespace json {
     }
     void PrintNode(const Node& value, const PrintContext& ctx);
     
-    void PrintString(const std::string& value, std::ostream& out) {
+    void PrintString(std::string_view value, std::ostream& out) {
     out.put('"');
         for (const char c : value) {
             switch (c) {
@@ -314,7 +490,7 @@ namespace json {
     }
 
     template <>
-    void PrintValue<std::string>(const std::string& value, const PrintContext& ctx) {
+    void PrintValue<String>(const String& value, const PrintContext& ctx) {
         PrintString(value, ctx.out);
     }
 
@@ -382,8 +558,106 @@ namespace json {
             node.GetNode());
     }
 
-    Document Load(std::istream& input) {
-        return Document{LoadNode(input)};
+    ///////////////////////////////////////
+
+    TreeHandler::TreeHandler(std::pmr::memory_resource* resource)
+        : resource_(resource) {
+    }
+
+    void TreeHandler::SetResource(std::pmr::memory_resource* resource) {
+        resource_ = resource;
+    }
+
+    void TreeHandler::Null() {
+        AddValue(Node());
+    }
+    void TreeHandler::Bool(bool value) {
+        AddValue(Node(value));
+    }
+    void TreeHandler::Int(int value) {
+        AddValue(Node(value));
+    }
+    void TreeHandler::Double(double value) {
+        AddValue(Node(value));
+    }
+    void TreeHandler::String(std::string_view value) {
+        AddValue(Node(json::String(value, resource_)));
+    }
+    void TreeHandler::Key(std::string_view key) {
+        stack_.back().key.assign(key.data(), key.size());
+    }
+    void TreeHandler::StartArray() {
+        StartFrame(false);
+    }
+    void TreeHandler::EndArray() {
+        Array array = move(stack_.back().array);
+        stack_.pop_back();
+        AddValue(Node(move(array)));
+    }
+    void TreeHandler::StartDict() {
+        StartFrame(true);
+    }
+    void TreeHandler::EndDict() {
+        Dict dict = move(stack_.back().dict);
+        stack_.pop_back();
+        AddValue(Node(move(dict)));
+    }
+
+    bool TreeHandler::IsComplete() const {
+        return root_.has_value();
+    }
+
+    Node TreeHandler::Extract() {
+        if (!root_) {
+            throw ParsingError("Incomplete JSON value"s);
+        }
+        Node result = move(*root_);
+        root_.reset();
+        return result;
+    }
+
+    // контейнеры уровня создаются с ресурсом обработчика, вложенные значения перемещаются в них без копирования
+    void TreeHandler::StartFrame(bool is_dict) {
+        stack_.push_back(Frame{ is_dict, Array(resource_), Dict(resource_), json::String(resource_) });
+    }
+
+    void TreeHandler::AddValue(Node&& node) {
+        if (stack_.empty()) {
+            root_ = move(node);
+        }
+        else if (Frame& frame = stack_.back(); frame.is_dict) {
+            frame.dict.emplace(move(frame.key), move(node));
+        }
+        else {
+            frame.array.push_back(move(node));
+        }
+    }
+
+    Document Load(std::istream& input, Document::Allocation allocation) {
+        const string buffer = ReadAll(input);
+        return Load(std::string_view(buffer), allocation);
+    }
+
+    Document Load(std::string_view input, Document::Allocation allocation) {
+        if (allocation == Document::Allocation::HEAP) {
+            TreeHandler handler;
+            Parser<TreeHandler>(input, handler).ParseValue();
+            return Document{handler.Extract()};
+        }
+        // дерево обычно занимает больше места, чем текст: первый блок арены — по размеру ввода
+        auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(std::max<size_t>(input.size(), 1 << 12));
+        TreeHandler handler(arena.get());
+        Parser<TreeHandler>(input, handler).ParseValue();
+        return Document{handler.Extract(), move(arena)};
+    }
+
+    void Parse(std::istream& input, Handler& handler) {
+        const string buffer = ReadAll(input);
+        Parse(std::string_view(buffer), handler);
+    }
+
+    void Parse(std::string_view input, Handler& handler) {
+        Parser<Handler>(input, handler).ParseValue();
     }
 
     void Print(const Document& doc, std::ostream& output) {
@@ -2,16 +2,32 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 
 namespace json {
 
 	class Node;
-	using Dict = std::map<std::string, Node>;
-	using Array = std::vector<Node>;
-	using Variable = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string>;
+	// строки, массивы и словари размещаются через std::pmr: по умолчанию в куче,
+	// при разборе с Document::Allocation::ARENA — в арене документа
+	using String = std::pmr::string;
+	using Array = std::pmr::vector<Node>;
+
+	class Dict final : public std::pmr::map<String, Node, std::less<>> {
+	public:
+		using map::map;
+
+		// значение по ключу без создания строки ключа; std::out_of_range, если ключа нет
+		const Node& at(std::string_view key) const;
+		Node& at(std::string_view key);
+	};
+
+	using Variable = std::variant<std::nullptr_t, Array, Dict, bool, int, double, String>;
 
 	// Эта ошибка должна выбрасываться при ошибках парсинга JSON
 	class ParsingError : public std::runtime_error {
@@ -22,6 +38,8 @@ namespace json {
 	class Node final : private Variable {
 	public:
 		using variant::variant;
+		// строка размещается в куче
+		Node(std::string_view value);
 
 		bool IsNull() const;
 		bool IsInt() const;
@@ -37,7 +55,7 @@ namespace json {
 		double AsDouble() const;
 		const int& AsInt() const;
 		const Dict& AsMap() const;
-		const std::string& AsString() const;
+		const String& AsString() const;
 		const Variable& GetNode() const { return *this; }
 
 		bool operator==(const Node& right) const;
@@ -46,7 +64,21 @@ namespace json {
 
 	class Document {
 	public:
+		// размещение узлов при разборе
+		enum class Allocation {
+			// каждый узел выделяется и освобождается в куче отдельно
+			HEAP,
+			// узлы размещаются в монотонной арене, которой владеет документ; арена освобождается целиком
+			ARENA
+		};
+
 		explicit Document(Node root);
+		// все строки и контейнеры root размещены в arena
+		Document(Node root, std::unique_ptr<std::pmr::monotonic_buffer_resource> arena);
+		Document(Document&&) = default;
+		// присваивание освободило бы арену раньше дерева
+		Document& operator=(Document&&) = delete;
+		~Document();
 
 		const Node& GetRoot() const;
 
@@ -54,10 +86,79 @@ namespace json {
 		bool operator!=(const Document& right) const;
 
 	private:
+		std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
 		Node root_;
 	};
 
-	Document Load(std::istream& input);
+	// Обработчик событий потокового разбора JSON: значения передаются по мере чтения,
+	// дерево Node не строится. Ключ словаря приходит событием Key перед своим значением.
+	// Строки String и Key действительны только во время вызова: это участок входного буфера
+	// или внутренний буфер разборщика
+	class Handler {
+	public:
+		virtual ~Handler() = default;
+
+		virtual void Null() = 0;
+		virtual void Bool(bool value) = 0;
+		virtual void Int(int value) = 0;
+		virtual void Double(double value) = 0;
+		virtual void String(std::string_view value) = 0;
+		virtual void Key(std::string_view key) = 0;
+		virtual void StartArray() = 0;
+		virtual void EndArray() = 0;
+		virtual void StartDict() = 0;
+		virtual void EndDict() = 0;
+	};
+
+	// Обработчик, собирающий из событий дерево Node.
+	// Может получать события одного значения внутри большого документа
+	class TreeHandler final : public Handler {
+	public:
+		// строки и контейнеры дерева размещаются в resource
+		explicit TreeHandler(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// ресурс для следующих значений; меняется только между значениями
+		void SetResource(std::pmr::memory_resource* resource);
+
+		void Null() override;
+		void Bool(bool value) override;
+		void Int(int value) override;
+		void Double(double value) override;
+		void String(std::string_view value) override;
+		void Key(std::string_view key) override;
+		void StartArray() override;
+		void EndArray() override;
+		void StartDict() override;
+		void EndDict() override;
+
+		// значение собрано полностью
+		bool IsComplete() const;
+		Node Extract();
+
+	private:
+		struct Frame {
+			bool is_dict = false;
+			Array array;
+			Dict dict;
+			json::String key;
+		};
+
+		std::pmr::memory_resource* resource_;
+		std::vector<Frame> stack_;
+		std::optional<Node> root_;
+
+		void AddValue(Node&& node);
+		void StartFrame(bool is_dict);
+	};
+
+	// разбор JSON: поток сначала целиком читается в буфер
+	Document Load(std::istream& input, Document::Allocation allocation = Document::Allocation::HEAP);
+	// разбор JSON из непрерывного буфера
+	Document Load(std::string_view input, Document::Allocation allocation = Document::Allocation::HEAP);
+
+	// потоковый разбор JSON с передачей событий обработчику
+	void Parse(std::istream& input, Handler& handler);
+	void Parse(std::string_view input, Handler& handler);
 
 	void Print(const Document& doc, std::ostream& output);
 
@@ -1,113 +1,713 @@
 #include "json_reader.h"
+#include "serialization.h"
 #include "transport_router.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory_resource>
+#include <numeric>
+#include <unordered_map>
+
 using namespace transport_catalogue;
 using namespace json_reader;
 using namespace map_renderer;
 using namespace transport_router;
 using namespace json;
 
+// Входной документ разбирается потоково: записи base_requests и stat_requests
+// собираются в Node по одной и сразу передаются в JsonReader, дерево всего документа не строится.
+// Запись base_requests не нужна после обработки: она собирается в арене с постоянным начальным буфером,
+// которая сбрасывается после каждой записи. Настройки и stat_requests хранятся дольше и размещаются в куче
+class JsonReader::RequestsStream final : public Handler {
+public:
+    explicit RequestsStream(JsonReader& reader)
+        : reader_(reader)
+        , item_buffer_(ITEM_BUFFER_SIZE)
+        , item_arena_(item_buffer_.data(), item_buffer_.size()) {
+    }
+
+    void Null() override {
+        if (BeginValue()) {
+            item_.Null();
+            CompleteValue();
+        }
+    }
+    void Bool(bool value) override {
+        if (BeginValue()) {
+            item_.Bool(value);
+            CompleteValue();
+        }
+    }
+    void Int(int value) override {
+        if (BeginValue()) {
+            item_.Int(value);
+            CompleteValue();
+        }
+    }
+    void Double(double value) override {
+        if (BeginValue()) {
+            item_.Double(value);
+            CompleteValue();
+        }
+    }
+    void String(std::string_view value) override {
+        if (BeginValue()) {
+            item_.String(value);
+            CompleteValue();
+        }
+    }
+    void Key(std::string_view key) override {
+        if (collecting_) {
+            item_.Key(key);
+        }
+        else if (depth_ == 1) {
+            section_ = GetSection(key);
+        }
+    }
+    void StartArray() override {
+        if (BeginValue()) {
+            item_.StartArray();
+        }
+        else {
+            ++depth_;
+        }
+    }
+    void EndArray() override {
+        if (collecting_) {
+            item_.EndArray();
+            CompleteValue();
+        }
+        else {
+            CloseContainer();
+        }
+    }
+    void StartDict() override {
+        if (BeginValue()) {
+            item_.StartDict();
+        }
+        else {
+            ++depth_;
+        }
+    }
+    void EndDict() override {
+        if (collecting_) {
+            item_.EndDict();
+            CompleteValue();
+        }
+        else {
+            CloseContainer();
+        }
+    }
+
+private:
+    enum class Section {
+        UNKNOWN,
+        BASE_REQUESTS,
+        RENDER_SETTINGS,
+        ROUTING_SETTINGS,
+        SERIALIZATION_SETTINGS,
+        EXECUTION_SETTINGS,
+        STAT_REQUESTS
+    };
+
+    // начальный буфер арены; запись base_requests больше него берёт дополнительные блоки из кучи
+    static constexpr size_t ITEM_BUFFER_SIZE = 1 << 16;
+
+    JsonReader& reader_;
+    Section section_ = Section::UNKNOWN;
+    // число открытых массивов и словарей вне собираемого значения
+    size_t depth_ = 0;
+    bool collecting_ = false;
+    std::vector<std::byte> item_buffer_;
+    std::pmr::monotonic_buffer_resource item_arena_;
+    TreeHandler item_;
+
+    static Section GetSection(std::string_view key) {
+        if (key == "base_requests"sv) {
+            return Section::BASE_REQUESTS;
+        }
+        else if (key == "render_settings"sv) {
+            return Section::RENDER_SETTINGS;
+        }
+        else if (key == "routing_settings"sv) {
+            return Section::ROUTING_SETTINGS;
+        }
+        else if (key == "serialization_settings"sv) {
+            return Section::SERIALIZATION_SETTINGS;
+        }
+        else if (key == "execution_settings"sv) {
+            return Section::EXECUTION_SETTINGS;
+        }
+        else if (key == "stat_requests"sv) {
+            return Section::STAT_REQUESTS;
+        }
+        return Section::UNKNOWN;
+    }
+
+    // true, если начинающееся значение нужно собрать в Node:
+    // настройки целиком, запросы — по одному элементу массива
+    bool BeginValue() {
+        if (collecting_) {
+            return true;
+        }
+        switch (section_) {
+        case Section::RENDER_SETTINGS:
+        case Section::ROUTING_SETTINGS:
+        case Section::SERIALIZATION_SETTINGS:
+        case Section::EXECUTION_SETTINGS:
+            collecting_ = depth_ == 1;
+            break;
+        case Section::BASE_REQUESTS:
+        case Section::STAT_REQUESTS:
+            collecting_ = depth_ == 2;
+            break;
+        default:
+            break;
+        }
+        if (collecting_) {
+            item_.SetResource(section_ == Section::BASE_REQUESTS ? &item_arena_ : std::pmr::get_default_resource());
+        }
+        return collecting_;
+    }
+
+    void CompleteValue() {
+        if (!item_.IsComplete()) {
+            return;
+        }
+        collecting_ = false;
+        Dispatch(item_.Extract());
+        // после обработки записи base_requests на её узлы никто не ссылается
+        item_arena_.release();
+    }
+
+    void Dispatch(Node&& value) {
+        switch (section_) {
+        case Section::BASE_REQUESTS:
+            reader_.AddBaseRequest(value.AsMap());
+            break;
+        case Section::RENDER_SETTINGS:
+            reader_.render_settings_ = value.AsMap();
+            break;
+        case Section::ROUTING_SETTINGS:
+            reader_.routing_settings_ = value.AsMap();
+            break;
+        case Section::SERIALIZATION_SETTINGS:
+            reader_.serialization_settings_ = value.AsMap();
+            break;
+        case Section::EXECUTION_SETTINGS:
+            reader_.SetExecutionSettings(value.AsMap());
+            break;
+        case Section::STAT_REQUESTS:
+            reader_.AddStatRequest(std::move(value));
+            break;
+        default:
+            break;
+        }
+    }
+
+    void CloseContainer() {
+        --depth_;
+        if (depth_ == 1 && section_ == Section::BASE_REQUESTS) {
+            reader_.FinishBaseRequests();
+        }
+    }
+};
+
+namespace {
+    // время обработки пакетов запросов в режиме сервера, в миллисекундах
+    class BatchLatencyStats {
+    public:
+        void Add(double latency) {
+            latencies_.push_back(latency);
+        }
+
+        size_t GetBatchCount() const {
+            return latencies_.size();
+        }
+
+        void Print(std::ostream& output) const {
+            if (latencies_.empty()) {
+                output << "batches: 0\n"sv;
+                return;
+            }
+            std::vector<double> sorted = latencies_;
+            std::sort(sorted.begin(), sorted.end());
+            auto percentile = [&sorted](double share) {
+                return sorted[static_cast<size_t>(share * (sorted.size() - 1))];
+            };
+            const double total = std::accumulate(sorted.begin(), sorted.end(), 0.);
+            output << "batches: "sv << sorted.size()
+                << ", latency ms: min "sv << sorted.front()
+                << ", mean "sv << total / sorted.size()
+                << ", p50 "sv << percentile(0.5)
+                << ", p95 "sv << percentile(0.95)
+                << ", p99 "sv << percentile(0.99)
+                << ", max "sv << sorted.back() << '\n';
+        }
+
+    private:
+        std::vector<double> latencies_;
+    };
+} // namespace
+
 JsonReader::JsonReader(std::ostream& output)
     : output_(output)
+    , responses_(output)
 {
 }
 
 void JsonReader::Reader() {
-    Node document_json = Load(std::cin).GetRoot();
-    Dict root = document_json.AsMap();
-    Array content_base;
-    Array content_state;
-    Dict render_settings;
-    Dict routing_settings;
-
-    content_base = root.at("base_requests"s).AsArray();
-    content_state = root.at("stat_requests"s).AsArray();
-    try {
-        render_settings = root.at("render_settings"s).AsMap();
-    }
-    catch (...) {};
-    try {
-        routing_settings = root.at("routing_settings"s).AsMap();
+    mode_ = Mode::FULL;
+    responses_.StartArray();
+    RequestsStream stream(*this);
+    Parse(std::cin, stream);
+
+    if (!base_loaded_) {
+        FinishBaseRequests();
     }
-    catch (...) {};
+    WriteResponses();
+}
 
-    FillCatalog(content_base);
+void JsonReader::MakeBase() {
+    mode_ = Mode::MAKE_BASE;
+    RequestsStream stream(*this);
+    Parse(std::cin, stream);
 
-    svg::Document map_svg;
-    if (!render_settings.empty()) {
-        RenderSettings settings = SetSettingsMap(render_settings);
-        map_catalogue_.SetBuses(transport_catalogue_.GetBuses())
-            .SetStopCoordinates(transport_catalogue_.GetAllStopsCoordinates())
-            .SetRenderSettings(settings)
-            .MapRendering(map_svg);
+    if (!base_loaded_) {
+        FinishBaseRequests();
     }
+    SaveSnapshot();
+}
+
+void JsonReader::ProcessRequests() {
+    mode_ = Mode::PROCESS_REQUESTS;
+    responses_.StartArray();
+    RequestsStream stream(*this);
+    Parse(std::cin, stream);
 
-    RouterSettings settings_router = SetSettingsRouter(routing_settings);
-    request_handler::RequestHandler processing(transport_catalogue_, map_catalogue_, settings_router);
-    processing.RequestProcess(content_state, map_svg, output_);
+    WriteResponses();
 }
 
-////////// base_requests //////////
-void JsonReader::FillCatalog(Array& value) {
-    std::vector<json::Node> bus_descriptions;
-    std::map<std::string, Dict> road_distances;
-    std::vector<std::string> bus_names;
+void JsonReader::Serve() {
+    mode_ = Mode::SERVE;
+    std::string line;
+    if (!std::getline(std::cin, line)) {
+        return;
+    }
+    RequestsStream stream(*this);
+    Parse(std::string_view(line), stream);
+    if (base_loaded_) {
+        PrepareRequestHandler();
+    }
+    else {
+        LoadSnapshot();
+    }
 
-    for (auto& description : value) {
-        if (description.AsMap().at("type"s) == "Stop"s) {
-            AddStop(description.AsMap());
-            road_distances[description.AsMap().at("name"s).AsString()] = description.AsMap().at("road_distances"s).AsMap();
+    BatchLatencyStats stats;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+            continue;
         }
-        else if (description.AsMap().at("type"s) == "Bus"s) {
-            bus_descriptions.push_back(description.AsMap());
-            bus_names.push_back(description.AsMap().at("name"s).AsString());
+        const auto start = std::chrono::steady_clock::now();
+        std::ostringstream batch;
+        size_t request_count = 0;
+        try {
+            request_count = AnswerBatch(Load(std::string_view(line), Document::Allocation::ARENA).GetRoot(), batch);
         }
-    }
+        catch (const std::exception& error) {
+            // ошибка в пакете не останавливает сервер: вместо ответов выводится сообщение об ошибке
+            batch.str(""s);
+            Writer writer(batch, Writer::Format::COMPACT);
+            writer.StartDict().Key("error_message"sv).Value(error.what()).EndDict();
+        }
+        output_ << batch.str() << '\n';
+        output_.flush();
 
-    for (Node& description : bus_descriptions) {
-        AddBus(description.AsMap());
+        const double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.Add(latency);
+        std::cerr << "batch "sv << stats.GetBatchCount() << ": "sv << request_count << " requests, "sv << latency << " ms\n"sv;
     }
+    stats.Print(std::cerr);
+}
 
-    for (auto& [stop_one, other] : road_distances) {
-        for (auto& [stop_two, distance] : other) {
-            transport_catalogue_.SetDistanceBetweenStops(stop_one, stop_two, distance.AsInt());
+size_t JsonReader::AnswerBatch(const Node& batch, std::ostream& output) {
+    static const Array NO_REQUESTS;
+    const Array* requests = &NO_REQUESTS;
+    if (batch.IsArray()) {
+        requests = &batch.AsArray();
+    }
+    else {
+        // пакет только с изменениями получает пустой массив ответов
+        const Dict& description = batch.AsMap();
+        const auto updates = description.find("update_requests"sv);
+        if (updates != description.end()) {
+            ApplyUpdates(updates->second.AsArray());
+        }
+        if (updates == description.end() || description.count("stat_requests"sv)) {
+            requests = &description.at("stat_requests"s).AsArray();
         }
     }
+    Writer writer(output, Writer::Format::COMPACT);
+    writer.StartArray();
+    request_handler_->RequestProcess(*requests, map_svg_, writer, pool_.get());
+    writer.EndArray();
+    return requests->size();
+}
+
+////////// base_requests //////////
+void JsonReader::AddBaseRequest(const Dict& description) {
+    // база в режиме process_requests берётся из снимка
+    if (mode_ == Mode::PROCESS_REQUESTS) {
+        return;
+    }
+    if (description.at("type"s) == "Stop"sv) {
+        AddStop(description);
+    }
+    else if (description.at("type"s) == "Bus"sv) {
+        AddBus(description);
+    }
 }
 
 void JsonReader::AddStop(const Dict& stop) {
-    std::string name;
+    std::string_view name = stop.at("name"s).AsString();
     double latitude;
     double longitude;
 
-    name = stop.at("name"s).AsString();
     latitude = stop.at("latitude"s).AsDouble();
     longitude = stop.at("longitude"s).AsDouble();
 
     transport_catalogue_.AddStop(name, { latitude, longitude });
+
+    // расстояния до ещё не добавленных остановок откладываются до конца base_requests
+    for (const auto& [stop_to, distance] : stop.at("road_distances"s).AsMap()) {
+        if (base_loaded_ || transport_catalogue_.FindStop(stop_to) != nullptr) {
+            transport_catalogue_.SetDistanceBetweenStops(name, stop_to, distance.AsInt());
+        }
+        else {
+            road_distances_.push_back({ std::string(name), std::string(stop_to), distance.AsInt() });
+        }
+    }
 }
 
 void JsonReader::AddBus(const Dict& bus) {
-    std::string name;
-    Array stope;
-    transport_catalogue::RouteType is_roundtrip;
+    std::string_view name = bus.at("name"s).AsString();
+    const Array& stops_names = bus.at("stops"s).AsArray();
+    transport_catalogue::RouteType is_roundtrip = bus.at("is_roundtrip"s).AsBool()
+        ? transport_catalogue::RouteType::IS_LOOPED
+        : transport_catalogue::RouteType::NOT_LOOPED;
 
-    name = bus.at("name"s).AsString();;
-
-    stope = bus.at("stops"s).AsArray();
-    std::vector<const Stop*> stops;
-    for (auto& kek : stope) {
-        stops.push_back(&transport_catalogue_.FindStop(kek.AsString()));
+    std::vector<StopId> stops;
+    stops.reserve(stops_names.size());
+    for (const Node& stop_name : stops_names) {
+        const Stop* stop = transport_catalogue_.FindStop(stop_name.AsString());
+        if (stop == nullptr && !base_loaded_) {
+            // маршрут добавится в конце base_requests, когда будут известны все остановки
+            BusDescription description{ std::string(name), {}, is_roundtrip == transport_catalogue::RouteType::IS_LOOPED };
+            description.stops.reserve(stops_names.size());
+            for (const Node& node : stops_names) {
+                description.stops.push_back(std::string(node.AsString()));
+            }
+            bus_descriptions_.push_back(std::move(description));
+            return;
+        }
+        stops.push_back(stop->id_);
     }
 
-    bus.at("is_roundtrip"s).AsBool() ? is_roundtrip = transport_catalogue::RouteType::IS_LOOPED : is_roundtrip = transport_catalogue::RouteType::NOT_LOOPED;
+    transport_catalogue_.AddBus(name, std::move(stops), is_roundtrip);
+}
+
+void JsonReader::AddBus(const BusDescription& bus) {
+    std::vector<StopId> stops;
+    stops.reserve(bus.stops.size());
+    for (const std::string& stop_name : bus.stops) {
+        const Stop* stop = transport_catalogue_.FindStop(stop_name);
+        if (stop == nullptr) {
+            throw std::invalid_argument("Bus "s + bus.name + " refers to an unknown stop "s + stop_name);
+        }
+        stops.push_back(stop->id_);
+    }
+    transport_catalogue_.AddBus(bus.name, std::move(stops),
+        bus.is_roundtrip ? transport_catalogue::RouteType::IS_LOOPED : transport_catalogue::RouteType::NOT_LOOPED);
+}
 
-    transport_catalogue_.AddBus(name, stops, is_roundtrip);
+void JsonReader::FinishBaseRequests() {
+    if (mode_ == Mode::PROCESS_REQUESTS) {
+        return;
+    }
+    for (const BusDescription& bus : bus_descriptions_) {
+        AddBus(bus);
+    }
+    for (const RoadDistance& road_distance : road_distances_) {
+        transport_catalogue_.SetDistanceBetweenStops(road_distance.from, road_distance.to, road_distance.distance);
+    }
+    std::vector<BusDescription>{}.swap(bus_descriptions_);
+    std::vector<RoadDistance>{}.swap(road_distances_);
+    // информация о маршрутах нужна только для ответов на запросы и считается в PrepareRequestHandler
+    base_loaded_ = true;
 }
 //-------- base_requests //--------
 
+////////// update_requests //////////
+// все изменения пакета читаются и проверяются до применения, поэтому пакет с ошибкой не меняет базу;
+// сообщение об ошибке содержит номер изменения
+void JsonReader::ApplyUpdates(const Array& updates) {
+    if (base_from_snapshot_) {
+        throw std::invalid_argument("update_requests need a base built from base_requests"s);
+    }
+    std::vector<UpdateRequest> requests;
+    requests.reserve(updates.size());
+    for (size_t i = 0; i < updates.size(); ++i) {
+        try {
+            requests.push_back(ParseUpdate(updates[i].AsMap()));
+        }
+        catch (const std::exception& error) {
+            throw std::invalid_argument("update_requests["s + std::to_string(i) + "]: "s + error.what());
+        }
+    }
+    ValidateUpdates(requests);
+    // проверенные изменения не должны приводить к ошибке; если она всё же случится, производные данные обновляются
+    try {
+        for (const UpdateRequest& update : requests) {
+            ApplyUpdate(update);
+        }
+    }
+    catch (...) {
+        FinishUpdates();
+        throw;
+    }
+    FinishUpdates();
+}
+
+JsonReader::UpdateRequest JsonReader::ParseUpdate(const Dict& update) {
+    UpdateRequest request;
+    const std::string_view type = update.at("type"s).AsString();
+    // отрицательное расстояние дало бы ребру графа отрицательный вес, и маршрутизатор не смог бы обновиться
+    auto get_distance = [](std::string_view from, std::string_view to, const Node& distance) {
+        const int value = distance.AsInt();
+        if (value < 0) {
+            throw std::invalid_argument("Negative distance from "s + std::string(from) + " to "s + std::string(to));
+        }
+        return value;
+    };
+    if (type == "Stop"sv) {
+        request.type = UpdateRequest::Type::STOP;
+        request.name = update.at("name"s).AsString();
+        request.point = { update.at("latitude"s).AsDouble(), update.at("longitude"s).AsDouble() };
+        if (const auto it = update.find("road_distances"sv); it != update.end()) {
+            for (const auto& [stop_to, distance] : it->second.AsMap()) {
+                request.road_distances.emplace_back(stop_to, get_distance(request.name, stop_to, distance));
+            }
+        }
+    }
+    else if (type == "Bus"sv) {
+        request.type = UpdateRequest::Type::BUS;
+        request.name = update.at("name"s).AsString();
+        request.is_roundtrip = update.at("is_roundtrip"s).AsBool();
+        for (const Node& stop_name : update.at("stops"s).AsArray()) {
+            request.stops.push_back(stop_name.AsString());
+        }
+        // маршрут без остановок не принимается
+        if (request.stops.empty()) {
+            throw std::invalid_argument("Bus "s + std::string(request.name) + " has no stops"s);
+        }
+    }
+    else if (type == "Distance"sv) {
+        request.type = UpdateRequest::Type::DISTANCE;
+        request.from = update.at("from"s).AsString();
+        request.to = update.at("to"s).AsString();
+        request.distance = get_distance(request.from, request.to, update.at("distance"s));
+    }
+    else if (type == "RemoveStop"sv) {
+        request.type = UpdateRequest::Type::REMOVE_STOP;
+        request.name = update.at("name"s).AsString();
+    }
+    else if (type == "RemoveBus"sv) {
+        request.type = UpdateRequest::Type::REMOVE_BUS;
+        request.name = update.at("name"s).AsString();
+    }
+    else if (type == "RemoveDistance"sv) {
+        request.type = UpdateRequest::Type::REMOVE_DISTANCE;
+        request.from = update.at("from"s).AsString();
+        request.to = update.at("to"s).AsString();
+    }
+    else {
+        throw std::invalid_argument("Unknown update type "s + std::string(type));
+    }
+    return request;
+}
+
+// изменения проверяются по порядку на каталоге с учётом предыдущих изменений пакета; каталог не меняется
+void JsonReader::ValidateUpdates(const std::vector<UpdateRequest>& updates) const {
+    // остановки, добавленные (true) или удалённые (false) пакетом
+    std::unordered_map<std::string_view, bool> stops_exist;
+    // маршруты, изменённые пакетом: их новые остановки или std::nullopt для удалённых
+    std::unordered_map<std::string_view, std::optional<std::vector<std::string_view>>> buses_stops;
+
+    auto has_stop = [this, &stops_exist](std::string_view name) {
+        const auto it = stops_exist.find(name);
+        return it != stops_exist.end() ? it->second : transport_catalogue_.FindStop(name) != nullptr;
+    };
+    auto has_bus = [this, &buses_stops](std::string_view name) {
+        const auto it = buses_stops.find(name);
+        return it != buses_stops.end() ? it->second.has_value() : transport_catalogue_.FindBus(name) != nullptr;
+    };
+    // маршрут, который после предыдущих изменений пакета проходит через остановку; пустой, если такого нет
+    auto find_stop_bus = [this, &buses_stops](std::string_view stop) -> std::string_view {
+        for (const auto& [bus, stops] : buses_stops) {
+            if (stops && std::find(stops->begin(), stops->end(), stop) != stops->end()) {
+                return bus;
+            }
+        }
+        const auto& buses_to_stops = transport_catalogue_.GetBusesToStops();
+        if (const auto it = buses_to_stops.find(stop); it != buses_to_stops.end()) {
+            for (std::string_view bus : it->second) {
+                if (!buses_stops.count(bus)) {
+                    return bus;
+                }
+            }
+        }
+        return {};
+    };
+
+    for (size_t i = 0; i < updates.size(); ++i) {
+        const UpdateRequest& update = updates[i];
+        std::string error;
+        auto check_stop = [&has_stop, &error](std::string_view name) {
+            if (error.empty() && !has_stop(name)) {
+                error = "Unknown stop "s + std::string(name);
+            }
+        };
+        switch (update.type) {
+        case UpdateRequest::Type::STOP:
+            stops_exist[update.name] = true;
+            for (const auto& [stop_to, distance] : update.road_distances) {
+                check_stop(stop_to);
+            }
+            break;
+        case UpdateRequest::Type::BUS:
+            for (std::string_view stop : update.stops) {
+                check_stop(stop);
+            }
+            buses_stops[update.name] = update.stops;
+            break;
+        case UpdateRequest::Type::DISTANCE:
+        case UpdateRequest::Type::REMOVE_DISTANCE:
+            check_stop(update.from);
+            check_stop(update.to);
+            break;
+        case UpdateRequest::Type::REMOVE_STOP:
+            check_stop(update.name);
+            if (const std::string_view bus = find_stop_bus(update.name); error.empty() && !bus.empty()) {
+                error = "Stop "s + std::string(update.name) + " is used by bus "s + std::string(bus);
+            }
+            stops_exist[update.name] = false;
+            break;
+        case UpdateRequest::Type::REMOVE_BUS:
+            if (!has_bus(update.name)) {
+                error = "Unknown bus "s + std::string(update.name);
+            }
+            buses_stops[update.name] = std::nullopt;
+            break;
+        }
+        if (!error.empty()) {
+            throw std::invalid_argument("update_requests["s + std::to_string(i) + "]: "s + error);
+        }
+    }
+}
+
+void JsonReader::ApplyUpdate(const UpdateRequest& update) {
+    switch (update.type) {
+    case UpdateRequest::Type::STOP:
+        UpdateStop(update);
+        break;
+    case UpdateRequest::Type::BUS:
+        UpdateBus(update);
+        break;
+    case UpdateRequest::Type::DISTANCE:
+        transport_catalogue_.SetDistanceBetweenStops(FindUpdateStop(update.from).id_, FindUpdateStop(update.to).id_, update.distance);
+        break;
+    case UpdateRequest::Type::REMOVE_STOP:
+        transport_catalogue_.RemoveStop(FindUpdateStop(update.name).id_);
+        break;
+    case UpdateRequest::Type::REMOVE_BUS:
+        transport_catalogue_.RemoveBus(transport_catalogue_.FindBus(update.name)->id_);
+        break;
+    case UpdateRequest::Type::REMOVE_DISTANCE:
+        transport_catalogue_.RemoveDistanceBetweenStops(FindUpdateStop(update.from).id_, FindUpdateStop(update.to).id_);
+        break;
+    }
+}
+
+// остановка с новым именем добавляется, с известным — перемещается; road_distances необязательны
+void JsonReader::UpdateStop(const UpdateRequest& stop) {
+    StopId id;
+    if (const Stop* existing = transport_catalogue_.FindStop(stop.name)) {
+        id = existing->id_;
+        transport_catalogue_.MoveStop(id, stop.point);
+    }
+    else {
+        id = transport_catalogue_.AddStop(stop.name, stop.point);
+    }
+    for (const auto& [stop_to, distance] : stop.road_distances) {
+        transport_catalogue_.SetDistanceBetweenStops(id, FindUpdateStop(stop_to).id_, distance);
+    }
+}
+
+// маршрут с новым номером добавляется, у известного заменяются остановки
+void JsonReader::UpdateBus(const UpdateRequest& bus) {
+    const transport_catalogue::RouteType loop = bus.is_roundtrip
+        ? transport_catalogue::RouteType::IS_LOOPED
+        : transport_catalogue::RouteType::NOT_LOOPED;
+    std::vector<StopId> stops;
+    stops.reserve(bus.stops.size());
+    for (std::string_view stop_name : bus.stops) {
+        stops.push_back(FindUpdateStop(stop_name).id_);
+    }
+    if (const Bus* existing = transport_catalogue_.FindBus(bus.name)) {
+        transport_catalogue_.SetBusStops(existing->id_, std::move(stops), loop);
+    }
+    else {
+        transport_catalogue_.AddBus(bus.name, std::move(stops), loop);
+    }
+}
+
+const Stop& JsonReader::FindUpdateStop(std::string_view name) const {
+    const Stop* stop = transport_catalogue_.FindStop(name);
+    if (stop == nullptr) {
+        throw std::invalid_argument("Unknown stop "s + std::string(name));
+    }
+    return *stop;
+}
+
+// информация о маршрутах, индекс остановок и маршрутизатор обновляются только в затронутой части;
+// карта зависит от границ всех остановок маршрутов, поэтому при её изменении она рисуется заново,
+// а в SVG выводится только при следующем запросе Map
+void JsonReader::FinishUpdates() {
+    const CatalogueChanges changes = transport_catalogue_.ApplyChanges(pool_.get());
+    if (changes.IsEmpty()) {
+        return;
+    }
+    if (changes.HasMapChanges()) {
+        map_svg_.Clear();
+        RenderMap();
+    }
+    request_handler_->Update(changes, changes.HasMapChanges(), pool_.get());
+}
+//-------- update_requests //--------
+
 ////////// render_settings //////////
-RenderSettings JsonReader::SetSettingsMap(Dict& render_settings) {
+void JsonReader::RenderMap() {
+    if (render_settings_ && !render_settings_->empty()) {
+        RenderSettings settings = SetSettingsMap(*render_settings_);
+        map_catalogue_.SetBuses(transport_catalogue_)
+            .SetRenderSettings(settings)
+            .MapRendering(map_svg_);
+    }
+}
+
+RenderSettings JsonReader::SetSettingsMap(const Dict& render_settings) {
     RenderSettings settings;
 
     settings.width = render_settings.at("width").AsDouble();
@@ -132,7 +732,7 @@ RenderSettings JsonReader::SetSettingsMap(Dict& render_settings) {
 
 const svg::Color JsonReader::GetColor(const Node& color) {
     if (color.IsString()) {
-        return svg::Color{ color.AsString() };
+        return svg::Color{ std::string(color.AsString()) };
     }
     else if (color.IsArray()) {
         if (color.AsArray().size() == 3) {
@@ -151,9 +751,161 @@ const svg::Color JsonReader::GetColor(const Node& color) {
 }
 
 ////////// routing_settings //////////
-RouterSettings JsonReader::SetSettingsRouter(Dict& router_settings) {
+RouterSettings JsonReader::SetSettingsRouter(const Dict& router_settings) {
     RouterSettings settings;
     settings.bus_wait_time = router_settings.at("bus_wait_time").AsInt();
     settings.bus_velocity = router_settings.at("bus_velocity").AsDouble() * 1000 / 60; // перевод из м/мин в км/ч
+    if (router_settings.count("walking_velocity"sv)) {
+        settings.walking_velocity = router_settings.at("walking_velocity"s).AsDouble();
+    }
+    settings.walking_velocity = settings.walking_velocity * 1000 / 60;
+    if (router_settings.count("max_walking_distance"sv)) {
+        settings.max_walking_distance = router_settings.at("max_walking_distance"s).AsDouble();
+    }
+    if (router_settings.count("router_mode"sv)) {
+        std::string_view mode = router_settings.at("router_mode"s).AsString();
+        if (mode == "precomputed"sv) {
+            settings.router_mode = graph::RouterMode::PRECOMPUTED;
+        }
+        else if (mode == "on_demand"sv) {
+            settings.router_mode = graph::RouterMode::ON_DEMAND;
+        }
+        else if (mode == "contraction_hierarchy"sv) {
+            settings.router_mode = graph::RouterMode::CONTRACTION_HIERARCHY;
+        }
+        else {
+            throw std::invalid_argument("Unknown router_mode: "s + std::string(mode));
+        }
+    }
+    if (router_settings.count("graph_model"sv)) {
+        std::string_view model = router_settings.at("graph_model"s).AsString();
+        if (model == "stop_pairs"sv) {
+            settings.graph_model = GraphModel::STOP_PAIRS;
+        }
+        else if (model == "boarding"sv) {
+            settings.graph_model = GraphModel::BOARDING;
+        }
+        else {
+            throw std::invalid_argument("Unknown graph_model: "s + std::string(model));
+        }
+    }
     return settings;
+}
+
+////////// serialization_settings //////////
+std::string JsonReader::GetSnapshotPath() const {
+    if (!serialization_settings_ || !serialization_settings_->count("file"sv)) {
+        throw std::invalid_argument("serialization_settings.file is required"s);
+    }
+    return std::string(serialization_settings_->at("file"s).AsString());
+}
+
+void JsonReader::SaveSnapshot() {
+    RenderMap();
+    std::ostringstream rendered_map;
+    map_svg_.Render(rendered_map);
+    TransportRouter router(transport_catalogue_, SetSettingsRouter(routing_settings_.value_or(Dict{})), pool_.get());
+
+    std::ofstream output(GetSnapshotPath(), std::ios::binary);
+    if (!output) {
+        throw std::runtime_error("Failed to open snapshot file "s + GetSnapshotPath());
+    }
+    serialization::SaveBase(output, transport_catalogue_, rendered_map.str(), router);
+}
+
+void JsonReader::LoadSnapshot() {
+    std::ifstream input(GetSnapshotPath(), std::ios::binary);
+    if (!input) {
+        throw std::runtime_error("Failed to open snapshot file "s + GetSnapshotPath());
+    }
+    serialization::BaseSnapshot snapshot = serialization::LoadBase(input, transport_catalogue_);
+    transport_catalogue_.BuildBusesInfo(pool_.get());
+    transport_catalogue_.BuildStopIndex();
+    base_loaded_ = true;
+    base_from_snapshot_ = true;
+
+    request_handler_ = std::make_unique<request_handler::RequestHandler>(transport_catalogue_, map_catalogue_, std::move(snapshot.router));
+    request_handler_->SetRenderedMap(std::move(snapshot.rendered_map));
+}
+
+////////// execution_settings //////////
+void JsonReader::SetExecutionSettings(const Dict& execution_settings) {
+    const auto it = execution_settings.find("thread_count"sv);
+    if (it == execution_settings.end()) {
+        return;
+    }
+    const int thread_count = it->second.AsInt();
+    if (thread_count < 0) {
+        throw std::invalid_argument("execution_settings.thread_count must be non-negative"s);
+    }
+    // 0 — по числу аппаратных потоков, 1 — запросы обрабатываются последовательно, как без настроек
+    if (thread_count == 1) {
+        pool_.reset();
+        return;
+    }
+    pool_ = std::make_unique<thread_pool::ThreadPool>(static_cast<size_t>(thread_count));
+    if (pool_->GetThreadCount() < 2) {
+        pool_.reset();
+    }
+}
+
+////////// stat_requests //////////
+// запросы обрабатываются по мере чтения, если база и настройки уже прочитаны
+bool JsonReader::IsReadyForStatRequests() const {
+    switch (mode_) {
+    case Mode::PROCESS_REQUESTS:
+        return serialization_settings_.has_value();
+    case Mode::MAKE_BASE:
+    case Mode::SERVE:
+        return false;
+    default:
+        return base_loaded_ && render_settings_.has_value() && routing_settings_.has_value();
+    }
+}
+
+void JsonReader::AddStatRequest(Node request) {
+    if (mode_ == Mode::MAKE_BASE || mode_ == Mode::SERVE) {
+        return;
+    }
+    if (!IsReadyForStatRequests()) {
+        stat_requests_.push_back(std::move(request));
+        return;
+    }
+    if (pool_) {
+        // с пулом потоков запросы обрабатываются пакетами, чтобы не держать в памяти весь массив
+        stat_requests_.push_back(std::move(request));
+        if (stat_requests_.size() >= PARALLEL_BATCH_SIZE) {
+            FlushStatRequests();
+        }
+        return;
+    }
+    FlushStatRequests();
+    request_handler_->RequestProcess(request.AsMap(), map_svg_, responses_);
+}
+
+void JsonReader::FlushStatRequests() {
+    if (!request_handler_) {
+        PrepareRequestHandler();
+    }
+    request_handler_->RequestProcess(stat_requests_, map_svg_, responses_, pool_.get());
+    Array{}.swap(stat_requests_);
+}
+
+void JsonReader::PrepareRequestHandler() {
+    if (mode_ == Mode::PROCESS_REQUESTS) {
+        LoadSnapshot();
+    }
+    else {
+        transport_catalogue_.BuildBusesInfo(pool_.get());
+        transport_catalogue_.BuildStopIndex();
+        RenderMap();
+        RouterSettings settings_router = SetSettingsRouter(routing_settings_.value_or(Dict{}));
+        request_handler_ = std::make_unique<request_handler::RequestHandler>(transport_catalogue_, map_catalogue_, settings_router, pool_.get());
+    }
+}
+
+void JsonReader::WriteResponses() {
+    FlushStatRequests();
+    responses_.EndArray();
+    responses_.Flush();
 }
\ No newline at end of file
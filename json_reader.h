@@ -2,29 +2,137 @@
 
 #include "request_handler.h"
 
+#include <memory>
+#include <optional>
+
 namespace json_reader {
     class JsonReader {
     public:
         JsonReader(std::ostream& output);
 
+        // обработка base_requests и stat_requests из одного документа
         void Reader();
+        // построение базы и запись её снимка в файл из serialization_settings
+        void MakeBase();
+        // ответы на stat_requests по снимку базы из serialization_settings
+        void ProcessRequests();
+        // режим сервера: первая строка ввода — документ с базой и настройками или только с serialization_settings,
+        // каждая следующая строка — пакет stat_requests (массив или словарь с ключом "stat_requests");
+        // словарь может содержать и update_requests — изменения базы, которые применяются до ответов на пакет.
+        // Ответ на пакет выводится одной строкой, время обработки пакетов — в std::cerr
+        void Serve();
 
     private:
+        enum class Mode {
+            FULL,
+            MAKE_BASE,
+            PROCESS_REQUESTS,
+            SERVE
+        };
+        // потоковый обработчик входного документа, передаёт записи в JsonReader по одной
+        class RequestsStream;
+
+        // маршрут, часть остановок которого ещё не встретилась во входных данных
+        struct BusDescription {
+            std::string name;
+            std::vector<std::string> stops;
+            bool is_roundtrip = false;
+        };
+        // расстояние до остановки, которая ещё не встретилась во входных данных
+        struct RoadDistance {
+            std::string from;
+            std::string to;
+            int distance = 0;
+        };
+
+        // изменение из update_requests, прочитанное до применения; строки ссылаются на узлы пакета
+        struct UpdateRequest {
+            enum class Type {
+                STOP,
+                BUS,
+                DISTANCE,
+                REMOVE_STOP,
+                REMOVE_BUS,
+                REMOVE_DISTANCE
+            };
+            Type type = Type::STOP;
+            std::string_view name; // Stop, Bus, RemoveStop, RemoveBus
+            std::string_view from; // Distance, RemoveDistance
+            std::string_view to;
+            geo::Coordinates point; // Stop
+            std::vector<std::pair<std::string_view, int>> road_distances; // Stop
+            std::vector<std::string_view> stops; // Bus
+            bool is_roundtrip = false; // Bus
+            int distance = 0; // Distance
+        };
+
+        // число запросов, накапливаемых перед параллельной обработкой
+        static constexpr size_t PARALLEL_BATCH_SIZE = 4096;
+
         std::ostream& output_;
+        Mode mode_ = Mode::FULL;
         transport_catalogue::TransportCatalogue transport_catalogue_;
-        json::Array print_;
         map_renderer::MapRender map_catalogue_;
+        svg::Document map_svg_;
+
+        std::vector<BusDescription> bus_descriptions_;
+        std::vector<RoadDistance> road_distances_;
+        bool base_loaded_ = false;
+        // база прочитана из снимка: в нём нет render_settings, карту не перерисовать, поэтому изменения не принимаются
+        bool base_from_snapshot_ = false;
+        std::optional<json::Dict> render_settings_;
+        std::optional<json::Dict> routing_settings_;
+        std::optional<json::Dict> serialization_settings_;
+
+        // запросы, пришедшие раньше базы или настроек
+        json::Array stat_requests_;
+        std::unique_ptr<request_handler::RequestHandler> request_handler_;
+        json::Writer responses_;
+        // пул потоков для stat_requests; нет пула — запросы обрабатываются последовательно
+        std::unique_ptr<thread_pool::ThreadPool> pool_;
 
         ////////// base_requests //////////
-        void FillCatalog(json::Array& value);
+        void AddBaseRequest(const json::Dict& description);
         void AddStop(const json::Dict& stop);
         void AddBus(const json::Dict& bus);
+        void AddBus(const BusDescription& bus);
+        void FinishBaseRequests();
+
+        ////////// update_requests //////////
+        void ApplyUpdates(const json::Array& updates);
+        // чтение изменения; std::invalid_argument, если тип неизвестен или у маршрута нет остановок
+        static UpdateRequest ParseUpdate(const json::Dict& update);
+        // std::invalid_argument с номером первого изменения, которое нельзя применить
+        void ValidateUpdates(const std::vector<UpdateRequest>& updates) const;
+        void ApplyUpdate(const UpdateRequest& update);
+        void UpdateStop(const UpdateRequest& stop);
+        void UpdateBus(const UpdateRequest& bus);
+        // остановка по имени; std::invalid_argument, если её нет
+        const transport_catalogue::Stop& FindUpdateStop(std::string_view name) const;
+        void FinishUpdates();
 
         ////////// render_settings //////////
-        map_renderer::RenderSettings SetSettingsMap(json::Dict& render_settings);
+        void RenderMap();
+        map_renderer::RenderSettings SetSettingsMap(const json::Dict& render_settings);
         const svg::Color GetColor(const json::Node& color);
 
         ////////// routing_settings //////////
-        transport_router::RouterSettings SetSettingsRouter(json::Dict& router_settings);
+        transport_router::RouterSettings SetSettingsRouter(const json::Dict& router_settings);
+
+        ////////// serialization_settings //////////
+        std::string GetSnapshotPath() const;
+        void SaveSnapshot();
+        void LoadSnapshot();
+
+        ////////// execution_settings //////////
+        void SetExecutionSettings(const json::Dict& execution_settings);
+
+        ////////// stat_requests //////////
+        bool IsReadyForStatRequests() const;
+        void AddStatRequest(json::Node request);
+        void FlushStatRequests();
+        void PrepareRequestHandler();
+        void WriteResponses();
+        size_t AnswerBatch(const json::Node& batch, std::ostream& output);
     };
 } // namespace json_reader
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+
+namespace json {
+using namespace std::literals;
+
+Writer::Writer(std::ostream& output, Format format)
+    : output_(output)
+    , format_(format) {
+    buffer_.reserve(BUFFER_SIZE);
+}
+
+Writer::~Writer() {
+    Flush();
+}
+
+Writer& Writer::Value(std::nullptr_t) {
+    BeginValue();
+    buffer_ += "null"sv;
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::Value(bool value) {
+    BeginValue();
+    buffer_ += value ? "true"sv : "false"sv;
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::Value(int value) {
+    BeginValue();
+    char digits[16];
+    auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), value);
+    buffer_.append(digits, end);
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeginValue();
+    // тот же формат, что и operator<< потока с текущей точностью
+    char digits[32];
+    int size = std::snprintf(digits, sizeof(digits), "%.*g", static_cast<int>(output_.precision()), value);
+    buffer_.append(digits, static_cast<size_t>(size));
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeginValue();
+    WriteString(value);
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::Value(const char* value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(const std::string& value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(const Node& value) {
+    if (value.IsNull()) {
+        return Value(nullptr);
+    }
+    else if (value.IsBool()) {
+        return Value(value.AsBool());
+    }
+    else if (value.IsInt()) {
+        return Value(value.AsInt());
+    }
+    else if (value.IsPureDouble()) {
+        return Value(value.AsDouble());
+    }
+    else if (value.IsString()) {
+        return Value(std::string_view(value.AsString()));
+    }
+    else if (value.IsArray()) {
+        StartArray();
+        for (const Node& node : value.AsArray()) {
+            Value(node);
+        }
+        return EndArray();
+    }
+    StartDict();
+    for (const auto& [key, node] : value.AsMap()) {
+        Key(key);
+        Value(node);
+    }
+    return EndDict();
+}
+
+Writer::KeyContext Writer::Key(std::string_view key) {
+    if (levels_.empty() || !levels_.back().is_dict || levels_.back().has_key) {
+        throw std::logic_error("Writer failed on Key");
+    }
+    Level& level = levels_.back();
+    if (!level.is_first) {
+        WriteSeparator();
+    }
+    level.is_first = false;
+    level.has_key = true;
+    WriteNewLine(levels_.size());
+    WriteString(key);
+    buffer_ += format_ == Format::PRETTY ? ": "sv : ":"sv;
+    return KeyContext{*this};
+}
+
+Writer::DictContext Writer::StartDict() {
+    BeginValue();
+    buffer_ += '{';
+    levels_.push_back({true});
+    return DictContext{*this};
+}
+
+Writer& Writer::EndDict() {
+    if (levels_.empty() || !levels_.back().is_dict || levels_.back().has_key) {
+        throw std::logic_error("Writer failed on EndDict");
+    }
+    CloseLevel();
+    buffer_ += '}';
+    EndValue();
+    return *this;
+}
+
+Writer::ArrayContext Writer::StartArray() {
+    BeginValue();
+    buffer_ += '[';
+    levels_.push_back({false});
+    return ArrayContext{*this};
+}
+
+Writer& Writer::EndArray() {
+    if (levels_.empty() || levels_.back().is_dict) {
+        throw std::logic_error("Writer failed on EndArray");
+    }
+    CloseLevel();
+    buffer_ += ']';
+    EndValue();
+    return *this;
+}
+
+Writer& Writer::AppendItems(std::string_view serialized_array) {
+    if (levels_.empty() || levels_.back().is_dict) {
+        throw std::logic_error("Writer failed on AppendItems");
+    }
+    // между скобками: элементы с их разделителями и переводом строки перед закрывающей скобкой
+    const size_t begin = serialized_array.find('[');
+    const size_t end = serialized_array.rfind(']');
+    if (begin == std::string_view::npos || end == std::string_view::npos || end < begin) {
+        throw std::invalid_argument("AppendItems expects a serialized array");
+    }
+    std::string_view items = serialized_array.substr(begin + 1, end - begin - 1);
+    if (format_ == Format::PRETTY) {
+        items = items.substr(0, items.rfind('\n'));
+    }
+    if (items.empty() || items == "\n"sv) {
+        return *this;
+    }
+    Level& level = levels_.back();
+    if (!level.is_first) {
+        WriteSeparator();
+    }
+    level.is_first = false;
+    buffer_ += items;
+    EndValue();
+    return *this;
+}
+
+Writer::Format Writer::GetFormat() const {
+    return format_;
+}
+
+void Writer::Flush() {
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
+// разделитель и отступ перед значением
+void Writer::BeginValue() {
+    if (levels_.empty()) {
+        if (has_root_) {
+            throw std::logic_error("Writer failed on Value");
+        }
+        has_root_ = true;
+        return;
+    }
+    Level& level = levels_.back();
+    if (level.is_dict) {
+        if (!level.has_key) {
+            throw std::logic_error("Writer failed on Value");
+        }
+        level.has_key = false;
+        return;
+    }
+    if (!level.is_first) {
+        WriteSeparator();
+    }
+    level.is_first = false;
+    WriteNewLine(levels_.size());
+}
+
+void Writer::EndValue() {
+    if (buffer_.size() >= BUFFER_SIZE) {
+        Flush();
+    }
+}
+
+// json::Print выводит пустой контейнер как открывающую скобку, пустую строку и закрывающую скобку
+void Writer::CloseLevel() {
+    if (format_ == Format::PRETTY && levels_.back().is_first) {
+        buffer_ += '\n';
+    }
+    levels_.pop_back();
+    WriteNewLine(levels_.size());
+}
+
+void Writer::WriteSeparator() {
+    buffer_ += ',';
+}
+
+// перевод строки и отступ перед элементом или закрывающей скобкой (только в формате PRETTY)
+void Writer::WriteNewLine(size_t depth) {
+    if (format_ == Format::PRETTY) {
+        buffer_ += '\n';
+        buffer_.append(depth * 4, ' ');
+    }
+}
+
+// символы " и \ выводятся как \" и \\, переводы строк — как \r и \n
+void Writer::WriteString(std::string_view value) {
+    buffer_ += '"';
+    size_t start = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        const char c = value[i];
+        if (c != '"' && c != '\\' && c != '\r' && c != '\n') {
+            continue;
+        }
+        buffer_.append(value.data() + start, i - start);
+        buffer_ += '\\';
+        buffer_ += c == '\r' ? 'r' : c == '\n' ? 'n' : c;
+        start = i + 1;
+    }
+    buffer_.append(value.data() + start, value.size() - start);
+    buffer_ += '"';
+}
+
+} // namespace json
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "json.h"
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+// класс, позволяющий записывать JSON цепочкой вызовов сразу в поток, без построения дерева Node.
+// Формат PRETTY совпадает с json::Print; ключи словаря выводятся в порядке вызовов Key
+class Writer {
+public:
+    class KeyContext;
+    class DictContext;
+    class ArrayContext;
+
+    enum class Format {
+        PRETTY,  // отступы и перевод строки после каждого элемента
+        COMPACT  // без пробелов и переводов строк: документ занимает одну строку
+    };
+
+    explicit Writer(std::ostream& output, Format format = Format::PRETTY);
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    ~Writer();
+
+    Writer& Value(std::nullptr_t);
+    Writer& Value(bool value);
+    Writer& Value(int value);
+    Writer& Value(double value);
+    Writer& Value(std::string_view value);
+    Writer& Value(const char* value);
+    Writer& Value(const std::string& value);
+    Writer& Value(const Node& value);
+    KeyContext Key(std::string_view key);
+
+    DictContext StartDict();
+    Writer& EndDict();
+
+    ArrayContext StartArray();
+    Writer& EndArray();
+
+    // добавление в открытый массив элементов массива, ранее записанного другим Writer
+    // того же формата на том же уровне вложенности (например, части ответов из другого потока)
+    Writer& AppendItems(std::string_view serialized_array);
+
+    Format GetFormat() const;
+
+    // передача накопленного буфера в поток
+    void Flush();
+
+private:
+    // размер буфера, при превышении которого он передаётся в поток
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    struct Level {
+        bool is_dict = false;
+        bool is_first = true;
+        bool has_key = false;
+    };
+
+    std::ostream& output_;
+    Format format_;
+    std::string buffer_;
+    std::vector<Level> levels_;
+    bool has_root_ = false;
+
+    void BeginValue();
+    void EndValue();
+    void CloseLevel();
+    void WriteSeparator();
+    void WriteNewLine(size_t depth);
+    void WriteString(std::string_view value);
+};
+
+// вспомогательный класс, позволяющий отследить ошибки неправильного вызова цепочки Key(...) на этапе компиляции
+class Writer::KeyContext {
+public:
+    explicit KeyContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    template <typename T>
+    DictContext Value(T&& value);
+
+    DictContext StartDict();
+
+    ArrayContext StartArray();
+
+private:
+    Writer& writer_;
+};
+
+// вспомогательный класс, позволяющий отследить ошибки неправильного вызова цепочки Dict() на этапе компиляции
+class Writer::DictContext {
+public:
+    explicit DictContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    KeyContext Key(std::string_view key) {
+        return writer_.Key(key);
+    }
+
+    Writer& EndDict() {
+        return writer_.EndDict();
+    }
+
+private:
+    Writer& writer_;
+};
+
+// вспомогательный класс, позволяющий отследить ошибки неправильного вызова цепочки Array() на этапе компиляции
+class Writer::ArrayContext {
+public:
+    explicit ArrayContext(Writer& writer)
+        : writer_(writer) {
+    }
+
+    template <typename T>
+    ArrayContext Value(T&& value) {
+        writer_.Value(std::forward<T>(value));
+        return *this;
+    }
+
+    DictContext StartDict() {
+        return writer_.StartDict();
+    }
+
+    ArrayContext StartArray() {
+        return writer_.StartArray();
+    }
+
+    Writer& EndArray() {
+        return writer_.EndArray();
+    }
+
+private:
+    Writer& writer_;
+};
+
+template <typename T>
+Writer::DictContext Writer::KeyContext::Value(T&& value) {
+    writer_.Value(std::forward<T>(value));
+    return DictContext{writer_};
+}
+
+inline Writer::DictContext Writer::KeyContext::StartDict() {
+    return writer_.StartDict();
+}
+
+inline Writer::ArrayContext Writer::KeyContext::StartArray() {
+    return writer_.StartArray();
+}
+
+} // namespace json
\ No newline at end of file
@@ -1,8 +1,38 @@
 #include <iostream>
+#include <string_view>
 
 #include "json_reader.h"
 
-int main() {
+using namespace std::literals;
+
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests|serve]\n"sv;
+}
+
+int main(int argc, char* argv[]) {
     json_reader::JsonReader processing(std::cout);
-    processing.Reader();
+    // без аргументов база и запросы читаются из одного документа
+    if (argc == 1) {
+        processing.Reader();
+        return 0;
+    }
+    if (argc != 2) {
+        PrintUsage();
+        return 1;
+    }
+
+    const std::string_view mode(argv[1]);
+    if (mode == "make_base"sv) {
+        processing.MakeBase();
+    }
+    else if (mode == "process_requests"sv) {
+        processing.ProcessRequests();
+    }
+    else if (mode == "serve"sv) {
+        processing.Serve();
+    }
+    else {
+        PrintUsage();
+        return 1;
+    }
 }
\ No newline at end of file
@@ -6,12 +6,13 @@
 using namespace map_renderer;
 using namespace std::literals;
 
-MapRender& MapRender::SetBuses(const std::deque<const transport_catalogue::Bus*> buses) {
-    buses_ = buses;
-    return *this;
-}
-MapRender& MapRender::SetStopCoordinates(const std::vector<geo::Coordinates> stops_coordinates) {
-    stops_coordinates_ = stops_coordinates;
+MapRender& MapRender::SetBuses(const transport_catalogue::TransportCatalogue& catalogue) {
+    catalogue_ = &catalogue;
+    buses_ = catalogue.GetBuses();
+    // маршрут без остановок нечего рисовать, и цвет палитры ему не достаётся
+    buses_.erase(std::remove_if(buses_.begin(), buses_.end(), [](const transport_catalogue::Bus* bus) {
+        return bus->stops_of_bus_.empty();
+        }), buses_.end());
     return *this;
 }
 MapRender& MapRender::SetRenderSettings(const RenderSettings& map_settings) {
@@ -20,10 +21,12 @@ MapRender& MapRender::SetRenderSettings(const RenderSettings& map_settings) {
 }
 
 MapRender& MapRender::MapRendering(svg::Document& map_svg) {
-    if (stops_coordinates_.empty()) return *this;
+    SetRouteStops();
+    if (route_stops_.empty()) return *this;
 
     SetMaxMinCoordinate();
     SetZoomCoeff();
+    SetStopPoints();
 
     DrawPolylineRoute(map_svg);
     DrawNameRoute(map_svg);
@@ -34,20 +37,15 @@ MapRender& MapRender::MapRendering(svg::Document& map_svg) {
 }
 
 void MapRender::DrawPolylineRoute(svg::Document& map_svg) {
-    std::vector<const transport_catalogue::Stop*> uniq_stop;
-
     for (size_t i = 0; i < buses_.size(); ++i) {
         svg::Polyline route_line;
         size_t number_color = i % map_settings_.color_palette.size();
-        uniq_stop.reserve(uniq_stop.size() + buses_[i]->stops_of_bus_.size());
-        for (const auto& stop : buses_[i]->stops_of_bus_) {
-            route_line.AddPoint(CoordinateCalculation(stop->coordinates_));
-
-            uniq_stop.push_back(stop);
+        for (transport_catalogue::StopId stop : buses_[i]->stops_of_bus_) {
+            route_line.AddPoint(stop_points_[stop]);
         }
         if (buses_[i]->loop_ == transport_catalogue::RouteType::NOT_LOOPED) {
             for (auto rev_it = ++buses_[i]->stops_of_bus_.rbegin(); rev_it != buses_[i]->stops_of_bus_.rend(); ++rev_it)
-                route_line.AddPoint(CoordinateCalculation((*rev_it)->coordinates_));
+                route_line.AddPoint(stop_points_[*rev_it]);
         }
         route_line.SetFillColor(svg::NoneColor)
             .SetStrokeColor(map_settings_.color_palette[number_color])
@@ -56,18 +54,11 @@ void MapRender::DrawPolylineRoute(svg::Document& map_svg) {
             .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
         map_svg.Add(route_line);
     }
-
-    std::sort(uniq_stop.begin(), uniq_stop.end(), [](auto lhs, auto rhs) {
-        return lhs->name_ < rhs->name_;
-        });
-    uniq_stop.erase(unique(uniq_stop.begin(), uniq_stop.end()), uniq_stop.end());
-
-    uniq_stop_ = std::move(uniq_stop);
 }
 
 void MapRender::DrawNameRoute(svg::Document& map_svg) {
     for (size_t i = 0; i < buses_.size(); ++i) {
-        svg::Point first_stop = CoordinateCalculation(buses_[i]->stops_of_bus_[0]->coordinates_);
+        svg::Point first_stop = stop_points_[buses_[i]->stops_of_bus_[0]];
         svg::Text route_substrate;
         svg::Text route_name;
         size_t number_color = i % map_settings_.color_palette.size();
@@ -82,7 +73,7 @@ void MapRender::DrawNameRoute(svg::Document& map_svg) {
 
         if (buses_[i]->loop_ == transport_catalogue::RouteType::NOT_LOOPED &&
             buses_[i]->stops_of_bus_[0] != buses_[i]->stops_of_bus_.back()) {
-            svg::Point last_stop = CoordinateCalculation(buses_[i]->stops_of_bus_.back()->coordinates_);
+            svg::Point last_stop = stop_points_[buses_[i]->stops_of_bus_.back()];
 
             route_substrate.SetFillColor(map_settings_.underlayer_color);
             FillText(PointType::ROUTE, TextType::SUBSTRATE, route_substrate, last_stop, buses_[i]->name_);
@@ -96,9 +87,9 @@ void MapRender::DrawNameRoute(svg::Document& map_svg) {
 }
 
 void MapRender::DrawCircleStop(svg::Document& map_svg) {
-    for (const auto& stop : uniq_stop_) {
+    for (transport_catalogue::StopId stop_id : uniq_stop_) {
         svg::Circle stop_symbol;
-        stop_symbol.SetCenter(CoordinateCalculation(stop->coordinates_))
+        stop_symbol.SetCenter(stop_points_[stop_id])
             .SetRadius(map_settings_.stop_radius)
             .SetFillColor("white"s);
         map_svg.Add(stop_symbol);
@@ -106,44 +97,55 @@ void MapRender::DrawCircleStop(svg::Document& map_svg) {
 }
 
 void MapRender::DrawNameStop(svg::Document& map_svg) {
-    for (const auto& stop : uniq_stop_) {
+    for (transport_catalogue::StopId stop_id : uniq_stop_) {
+        const transport_catalogue::Stop& stop = catalogue_->GetStop(stop_id);
         svg::Text stop_substrate;
         svg::Text stop_name;
 
         stop_substrate.SetFillColor(map_settings_.underlayer_color);
-        FillText(PointType::STOP, TextType::SUBSTRATE, stop_substrate, CoordinateCalculation(stop->coordinates_), stop->name_);
+        FillText(PointType::STOP, TextType::SUBSTRATE, stop_substrate, stop_points_[stop_id], stop.name_);
         stop_name.SetFillColor("black"s);
-        FillText(PointType::STOP, TextType::NAME, stop_name, CoordinateCalculation(stop->coordinates_), stop->name_);
+        FillText(PointType::STOP, TextType::NAME, stop_name, stop_points_[stop_id], stop.name_);
 
         map_svg.Add(stop_substrate);
         map_svg.Add(stop_name);
     }
 }
 
-void MapRender::SetMaxMinCoordinate() {
-    const auto [left_it, right_it] = std::minmax_element(stops_coordinates_.begin(), stops_coordinates_.end(),
-        [](auto lhs, auto rhs) {
-            return lhs.lng < rhs.lng;
-        });
+// остановки всех маршрутов без повторов; по возрастанию StopId координаты читаются подряд
+void MapRender::SetRouteStops() {
+    std::vector<bool> is_route_stop(catalogue_->GetStopCount(), false);
+    for (const transport_catalogue::Bus* bus : buses_) {
+        for (transport_catalogue::StopId stop : bus->stops_of_bus_) {
+            is_route_stop[stop] = true;
+        }
+    }
+    route_stops_.clear();
+    for (transport_catalogue::StopId stop = 0; stop < is_route_stop.size(); ++stop) {
+        if (is_route_stop[stop]) {
+            route_stops_.push_back(stop);
+        }
+    }
 
-    const auto [bottom_it, top_it] = std::minmax_element(stops_coordinates_.begin(), stops_coordinates_.end(),
-        [](auto lhs, auto rhs) {
-            return lhs.lat < rhs.lat;
+    uniq_stop_ = route_stops_;
+    std::sort(uniq_stop_.begin(), uniq_stop_.end(), [this](auto lhs, auto rhs) {
+        return catalogue_->GetStop(lhs).name_ < catalogue_->GetStop(rhs).name_;
         });
-    geo::Coordinates max{ top_it->lat, right_it->lng };
-    geo::Coordinates min{ bottom_it->lat, left_it->lng };
-    max_min_ = std::make_pair(max, min);
+}
+
+void MapRender::SetMaxMinCoordinate() {
+    bounding_box_ = catalogue_->GetStopCoordinates().ComputeBoundingBox(route_stops_.data(), route_stops_.size());
 }
 
 void MapRender::SetZoomCoeff() {
     std::optional<double> width_zoom_coeff;
-    if (!(std::abs(max_min_.first.lng - max_min_.second.lng) < 1e-6)) {
-        width_zoom_coeff = (map_settings_.width - 2 * map_settings_.padding) / (max_min_.first.lng - max_min_.second.lng);
+    if (!(std::abs(bounding_box_.max.lng - bounding_box_.min.lng) < 1e-6)) {
+        width_zoom_coeff = (map_settings_.width - 2 * map_settings_.padding) / (bounding_box_.max.lng - bounding_box_.min.lng);
     }
 
     std::optional<double> height_zoom_coeff;
-    if (!(std::abs(max_min_.first.lat - max_min_.second.lat) < 1e-6)) {
-        height_zoom_coeff = (map_settings_.height - 2 * map_settings_.padding) / (max_min_.first.lat - max_min_.second.lat);
+    if (!(std::abs(bounding_box_.max.lat - bounding_box_.min.lat) < 1e-6)) {
+        height_zoom_coeff = (map_settings_.height - 2 * map_settings_.padding) / (bounding_box_.max.lat - bounding_box_.min.lat);
     }
 
     if (width_zoom_coeff && height_zoom_coeff) {
@@ -157,15 +159,21 @@ void MapRender::SetZoomCoeff() {
     }
 }
 
-svg::Point MapRender::CoordinateCalculation(geo::Coordinates coordinate) {
-    return { (coordinate.lng - max_min_.second.lng) * zoom_coeff_ + map_settings_.padding,
-            (max_min_.first.lat - coordinate.lat) * zoom_coeff_ + map_settings_.padding };
+// проекция остановок маршрутов на карту одним проходом по массивам широт и долгот
+void MapRender::SetStopPoints() {
+    const std::vector<double>& lats = catalogue_->GetStopCoordinates().GetLats();
+    const std::vector<double>& lngs = catalogue_->GetStopCoordinates().GetLngs();
+    stop_points_.assign(lats.size(), svg::Point{ 0.0, 0.0 });
+    for (transport_catalogue::StopId stop : route_stops_) {
+        stop_points_[stop] = { (lngs[stop] - bounding_box_.min.lng) * zoom_coeff_ + map_settings_.padding,
+            (bounding_box_.max.lat - lats[stop]) * zoom_coeff_ + map_settings_.padding };
+    }
 }
 
-void MapRender::FillText(PointType point_type, TextType text_type, svg::Text& text_svg, svg::Point stop_coordinate, std::string data) {
+void MapRender::FillText(PointType point_type, TextType text_type, svg::Text& text_svg, svg::Point stop_coordinate, std::string_view data) {
     text_svg.SetPosition(stop_coordinate)
         .SetFontFamily("Verdana"s)
-        .SetData(data);
+        .SetData(std::string(data));
 
     if (point_type == PointType::ROUTE) {
         text_svg.SetFontWeight("bold"s)
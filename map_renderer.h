@@ -33,28 +33,33 @@ namespace map_renderer {
     public:
         MapRender() = default;
 
-        MapRender& SetBuses(const std::deque<const transport_catalogue::Bus*> buses);
-        MapRender& SetStopCoordinates(const std::vector<geo::Coordinates> stops_coordinates);
+        // маршруты каталога с остановками в порядке номеров; остановки маршрутов берутся из него же по StopId
+        MapRender& SetBuses(const transport_catalogue::TransportCatalogue& catalogue);
         MapRender& SetRenderSettings(const RenderSettings& map_settings);
 
         MapRender& MapRendering(svg::Document& map_svg);
 
     private:
         RenderSettings map_settings_;
+        const transport_catalogue::TransportCatalogue* catalogue_ = nullptr;
         std::deque<const transport_catalogue::Bus*> buses_;
-        std::vector<const transport_catalogue::Stop*> uniq_stop_;
-        std::vector<geo::Coordinates> stops_coordinates_;
-        std::pair<geo::Coordinates, geo::Coordinates> max_min_;
+        // остановки маршрутов без повторов: по возрастанию StopId и по имени (в порядке отрисовки)
+        std::vector<transport_catalogue::StopId> route_stops_;
+        std::vector<transport_catalogue::StopId> uniq_stop_;
+        geo::BoundingBox bounding_box_;
         double zoom_coeff_ = 0.0;
+        // точки карты остановок маршрутов (индекс — StopId)
+        std::vector<svg::Point> stop_points_;
 
         void DrawPolylineRoute(svg::Document& map_svg);
         void DrawNameRoute(svg::Document& map_svg);
         void DrawCircleStop(svg::Document& map_svg);
         void DrawNameStop(svg::Document& map_svg);
 
+        void SetRouteStops();
         void SetMaxMinCoordinate();
         void SetZoomCoeff();
-        svg::Point CoordinateCalculation(geo::Coordinates coordinate);
-        void FillText(PointType point_type, TextType text_type, svg::Text& text_svg, svg::Point stop_coordinate, std::string data);
+        void SetStopPoints();
+        void FillText(PointType point_type, TextType text_type, svg::Text& text_svg, svg::Point stop_coordinate, std::string_view data);
     };
 } // namespace map_renderer
\ No newline at end of file
@@ -1,148 +1,317 @@
 #include "request_handler.h"
 
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <limits>
+#include <optional>
+#include <vector>
+
 using namespace request_handler;
 using namespace transport_catalogue;
 using namespace json;
 using namespace std::literals;
 
-RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, const transport_router::RouterSettings& settings_router)
+RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, const transport_router::RouterSettings& settings_router,
+                               thread_pool::ThreadPool* pool)
     : catalog_(catalog)
     , map_catalog_(map_catalog)
-    , transport_router_(catalog, settings_router)
+    , transport_router_(catalog, settings_router, pool)
 {
 }
 
-void RequestHandler::RequestProcess(json::Array& value, svg::Document& map_svg, std::ostream& output) {
-    Builder request{};
-    request.StartArray();
-    for (auto& description : value) {
-        if (description.AsMap().at("type"s) == "Stop"s) {
-            StopInfoPrint(description.AsMap(), request);
-        }
-        else if (description.AsMap().at("type"s) == "Bus"s) {
-            BusInfoPrint(description.AsMap(), request);
+RequestHandler::RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, transport_router::RouterSnapshot router_snapshot)
+    : catalog_(catalog)
+    , map_catalog_(map_catalog)
+    , transport_router_(catalog, std::move(router_snapshot))
+{
+}
+
+void RequestHandler::SetRenderedMap(std::string rendered_map) {
+    std::call_once(*map_rendered_, [this, &rendered_map] {
+        rendered_map_ = std::move(rendered_map);
+    });
+}
+
+void RequestHandler::Update(const CatalogueChanges& changes, bool is_map_changed, thread_pool::ThreadPool* pool) {
+    transport_router_.Update(changes, pool);
+    if (is_map_changed) {
+        map_rendered_ = std::make_unique<std::once_flag>();
+        rendered_map_.clear();
+    }
+}
+
+void RequestHandler::RequestProcess(const json::Array& requests, const svg::Document& map_svg, json::Writer& request, thread_pool::ThreadPool* pool) const {
+    if (pool == nullptr || pool->GetThreadCount() < 2 || requests.size() < 2) {
+        for (const Node& description : requests) {
+            RequestProcess(description.AsMap(), map_svg, request);
         }
-        else if (description.AsMap().at("type"s) == "Map"s) {
-            MapPrint(description.AsMap().at("id"s).AsInt(), map_svg, request);
+        return;
+    }
+
+    // части поменьше, чем requests / threads: время ответа на запрос Route заметно различается,
+    // и освободившийся поток забирает из очереди следующую часть
+    const size_t chunk_size = std::clamp<size_t>(requests.size() / (pool->GetThreadCount() * 8), 1, MAX_CHUNK_SIZE);
+    const Writer::Format format = request.GetFormat();
+    std::vector<std::future<std::string>> chunks;
+    chunks.reserve(requests.size() / chunk_size + 1);
+    for (size_t begin = 0; begin < requests.size(); begin += chunk_size) {
+        const size_t end = std::min(begin + chunk_size, requests.size());
+        chunks.push_back(pool->Submit([this, &requests, &map_svg, format, begin, end] {
+            std::ostringstream output;
+            {
+                Writer chunk(output, format);
+                chunk.StartArray();
+                for (size_t i = begin; i < end; ++i) {
+                    RequestProcess(requests[i].AsMap(), map_svg, chunk);
+                }
+                chunk.EndArray();
+            }
+            return output.str();
+        }));
+    }
+
+    // задачи ссылаются на requests, поэтому при ошибке сначала дожидаемся всех частей
+    std::exception_ptr error;
+    for (std::future<std::string>& chunk : chunks) {
+        try {
+            std::string items = chunk.get();
+            if (!error) {
+                request.AppendItems(items);
+            }
         }
-        else if (description.AsMap().at("type"s) == "Route"s) {
-            RoutePrint(description.AsMap(), request);
+        catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
         }
     }
-    request.EndArray();
-    Print(Document{ request.Build() }, output);
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-void RequestHandler::StopInfoPrint(const Dict& value, Builder& request) {
-    int id = value.at("id"s).AsInt();
-    std::string name = value.at("name"s).AsString();
+void RequestHandler::RequestProcess(const json::Dict& description, const svg::Document& map_svg, json::Writer& request) const {
+    const Node& type = description.at("type"s);
+    if (type == "Stop"sv) {
+        StopInfoPrint(description, request);
+    }
+    else if (type == "Bus"sv) {
+        BusInfoPrint(description, request);
+    }
+    else if (type == "Map"sv) {
+        MapPrint(description.at("id"s).AsInt(), map_svg, request);
+    }
+    else if (type == "Route"sv) {
+        RoutePrint(description, request);
+    }
+    else if (type == "NearestStops"sv) {
+        NearestStopsPrint(description, request);
+    }
+}
 
-    std::set<std::string_view> buses;
+// ключи ответов выводятся в алфавитном порядке, как при печати json::Dict
+void RequestHandler::StopInfoPrint(const Dict& value, Writer& request) const {
+    int id = value.at("id"s).AsInt();
+    std::string_view name = value.at("name"s).AsString();
 
-    if (catalog_.FindStop(name).name_ == "Error"s) {
+    if (catalog_.FindStop(name) == nullptr) {
         request.StartDict()
-            .Key("request_id"s).Value(id)
-            .Key("error_message"s).Value("not found"s);
+            .Key("error_message"sv).Value("not found"sv)
+            .Key("request_id"sv).Value(id);
     }
     else {
         request.StartDict()
-            .Key("buses"s).StartArray();
-        try {
-            buses = catalog_.GetBusesToStops().at(name);
-            for (auto& bus : buses) {
-                request.Value(std::string(bus));
+            .Key("buses"sv).StartArray();
+        const auto& buses_to_stops = catalog_.GetBusesToStops();
+        if (auto it = buses_to_stops.find(name); it != buses_to_stops.end()) {
+            for (std::string_view bus : it->second) {
+                request.Value(bus);
             }
         }
-        catch (...) {}
         request.EndArray()
-            .Key("request_id"s).Value(id);
+            .Key("request_id"sv).Value(id);
     }
     request.EndDict();
 }
 
-void RequestHandler::BusInfoPrint(const Dict& value, Builder& request) {
-    std::string name = value.at("name"s).AsString();
+void RequestHandler::BusInfoPrint(const Dict& value, Writer& request) const {
+    std::string_view name = value.at("name"s).AsString();
     int id = value.at("id"s).AsInt();
-    double curvature;
-    double route_length;
-    size_t stop_count;
-    size_t unique_stop_count;
-
-    Bus route = catalog_.FindBus(name);
 
     request.StartDict();
-    if (route.name_ == "Error"s) {
-        request.Key("request_id"s).Value(id)
-               .Key("error_message"s).Value("not found"s);
+    const BusInfo* info = catalog_.GetBusInfo(name);
+    if (info == nullptr) {
+        request.Key("error_message"sv).Value("not found"sv)
+               .Key("request_id"sv).Value(id);
     }
     else {
-        BusInfo info = catalog_.GetBusInfo(value.at("name"s).AsString());
-        curvature = info.curvature_;
-        route_length = info.real_distance_length_;
-        stop_count = info.stops_num_;
-        unique_stop_count = info.unique_stops_num_;
-        request.Key("curvature"s).Value(curvature)
-            .Key("request_id"s).Value(id)
-            .Key("route_length"s).Value(route_length)
-            .Key("stop_count"s).Value(int(stop_count))
-            .Key("unique_stop_count"s).Value(int(unique_stop_count));
+        request.Key("curvature"sv).Value(info->curvature_)
+            .Key("request_id"sv).Value(id)
+            .Key("route_length"sv).Value(info->real_distance_length_)
+            .Key("stop_count"sv).Value(int(info->stops_num_))
+            .Key("unique_stop_count"sv).Value(int(info->unique_stops_num_));
     }
     request.EndDict();
 }
 
-void RequestHandler::MapPrint(int id, svg::Document& map_svg, Builder& request) {
-    std::ostringstream svg;
-    map_svg.Render(svg);
-
+void RequestHandler::MapPrint(int id, const svg::Document& map_svg, Writer& request) const {
     request.StartDict()
-        .Key("map"s).Value(svg.str())
-        .Key("request_id"s).Value(id)
+        .Key("map"sv).Value(GetRenderedMap(map_svg))
+        .Key("request_id"sv).Value(id)
         .EndDict();
 }
 
-void RequestHandler::RoutePrint(const Dict& value, Builder& request) {
-    const std::string from = value.at("from"s).AsString();
-    const std::string to = value.at("to"s).AsString();
+// первый запрос Map выводит карту, остальные потоки ждут его завершения в std::call_once
+const std::string& RequestHandler::GetRenderedMap(const svg::Document& map_svg) const {
+    std::call_once(*map_rendered_, [this, &map_svg] {
+        std::ostringstream svg;
+        map_svg.Render(svg);
+        rendered_map_ = svg.str();
+    });
+    return rendered_map_;
+}
+
+void RequestHandler::RoutePrint(const Dict& value, Writer& request) const {
+    if (value.at("from"s).IsMap()) {
+        JourneyPrint(value, request);
+        return;
+    }
+    std::string_view from = value.at("from"s).AsString();
+    std::string_view to = value.at("to"s).AsString();
     int id = value.at("id"s).AsInt();
 
-    std::optional<std::vector<transport_router::RouterEdge>> route = transport_router_.BuildRoute(from, to);
+    // неизвестная или удалённая остановка отвечается так же, как запрос Stop
+    std::optional<std::vector<transport_router::RouterEdge>> route;
+    if (catalog_.FindStop(from) != nullptr && catalog_.FindStop(to) != nullptr) {
+        route = transport_router_.BuildRoute(from, to);
+    }
 
     if (!route.has_value()) {
         request.StartDict()
-                  .Key("request_id"s).Value(id)
-                  .Key("error_message"s).Value("not found"s)
+                  .Key("error_message"sv).Value("not found"sv)
+                  .Key("request_id"sv).Value(id)
                .EndDict();
         return;
     }
 
     double total_time = 0;
     int wait_time = transport_router_.GetSettings().bus_wait_time;
-    json::Array items;
+    request.StartDict()
+        .Key("items"sv).StartArray();
     for (const transport_router::RouterEdge& edge : route.value()) {
         total_time += edge.total_time;
 
-        json::Dict item_wait = json::Builder{}
-            .StartDict()
-                .Key("type"s).Value("Wait"s)
-                .Key("stop_name"s).Value(std::string(edge.stop_name_from))
-                .Key("time"s).Value(wait_time)
+        request.StartDict()
+                .Key("stop_name"sv).Value(edge.stop_name_from)
+                .Key("time"sv).Value(wait_time)
+                .Key("type"sv).Value("Wait"sv)
             .EndDict()
-            .Build().AsMap();
-        json::Dict item_move = json::Builder{}
             .StartDict()
-                .Key("type"s).Value("Bus"s)
-                .Key("bus"s).Value(std::string(edge.bus_name))
-                .Key("span_count"s).Value(edge.stop_count)
-                .Key("time"s).Value(edge.total_time - wait_time)
+                .Key("bus"sv).Value(edge.bus_name)
+                .Key("span_count"sv).Value(edge.stop_count)
+                .Key("time"sv).Value(edge.total_time - wait_time)
+                .Key("type"sv).Value("Bus"sv)
+            .EndDict();
+    }
+    request.EndArray()
+        .Key("request_id"sv).Value(id)
+        .Key("total_time"sv).Value(total_time)
+        .EndDict();
+}
+
+// маршрут между точками: "from" и "to" заданы словарями с latitude и longitude;
+// пешие участки выводятся элементами Walk, поездки — так же, как в маршруте между остановками.
+// Пешком напрямую, до остановки и от неё можно пройти не больше max_walking_distance:
+// если ни маршрута через остановки, ни такого пешего пути нет, выводится "not found"
+void RequestHandler::JourneyPrint(const Dict& value, Writer& request) const {
+    auto coordinates = [](const Dict& point) {
+        return geo::Coordinates{ point.at("latitude"s).AsDouble(), point.at("longitude"s).AsDouble() };
+    };
+    auto walk_print = [&request](const transport_router::WalkEdge& walk) {
+        request.StartDict()
+            .Key("distance"sv).Value(walk.distance);
+        if (!walk.stop_name.empty()) {
+            request.Key("stop_name"sv).Value(walk.stop_name);
+        }
+        request.Key("time"sv).Value(walk.total_time)
+            .Key("type"sv).Value("Walk"sv)
+            .EndDict();
+    };
+    int id = value.at("id"s).AsInt();
+    const std::optional<transport_router::Journey> journey = transport_router_.BuildRoute(
+        coordinates(value.at("from"s).AsMap()), coordinates(value.at("to"s).AsMap()));
+    if (!journey) {
+        request.StartDict()
+                  .Key("error_message"sv).Value("not found"sv)
+                  .Key("request_id"sv).Value(id)
+               .EndDict();
+        return;
+    }
+
+    int wait_time = transport_router_.GetSettings().bus_wait_time;
+    request.StartDict()
+        .Key("items"sv).StartArray();
+    walk_print(journey->access);
+    for (const transport_router::RouterEdge& edge : journey->edges) {
+        request.StartDict()
+                .Key("stop_name"sv).Value(edge.stop_name_from)
+                .Key("time"sv).Value(wait_time)
+                .Key("type"sv).Value("Wait"sv)
             .EndDict()
-            .Build().AsMap();
+            .StartDict()
+                .Key("bus"sv).Value(edge.bus_name)
+                .Key("span_count"sv).Value(edge.stop_count)
+                .Key("time"sv).Value(edge.total_time - wait_time)
+                .Key("type"sv).Value("Bus"sv)
+            .EndDict();
+    }
+    if (journey->egress) {
+        walk_print(*journey->egress);
+    }
+    request.EndArray()
+        .Key("request_id"sv).Value(id)
+        .Key("total_time"sv).Value(journey->total_time)
+        .EndDict();
+}
 
-        items.push_back(item_wait);
-        items.push_back(item_move);
+// count — не более count ближайших остановок, radius — все остановки в радиусе (в метрах); вместе — не более count в радиусе.
+// Без count и radius или с отрицательным значением на запрос выводится сообщение об ошибке, остальные запросы обрабатываются
+void RequestHandler::NearestStopsPrint(const Dict& value, Writer& request) const {
+    int id = value.at("id"s).AsInt();
+    const geo::Coordinates point{ value.at("latitude"s).AsDouble(), value.at("longitude"s).AsDouble() };
+    const auto count = value.find("count"sv);
+    const auto radius = value.find("radius"sv);
+    std::string_view error_message;
+    if (count == value.end() && radius == value.end()) {
+        error_message = "count or radius is required"sv;
     }
-     request.StartDict()
-                .Key("request_id"s).Value(id)
-                .Key("total_time"s).Value(total_time)
-                .Key("items"s).Value(items)
+    else if ((count != value.end() && count->second.AsInt() < 0) || (radius != value.end() && radius->second.AsDouble() < 0)) {
+        error_message = "count and radius must be non-negative"sv;
+    }
+    if (!error_message.empty()) {
+        request.StartDict()
+                .Key("error_message"sv).Value(error_message)
+                .Key("request_id"sv).Value(id)
             .EndDict();
+        return;
+    }
+
+    const StopIndex& index = catalog_.GetStopIndex();
+    const std::vector<StopIndex::Neighbour> stops = count == value.end()
+        ? index.FindWithin(point, radius->second.AsDouble())
+        : index.FindNearest(point, static_cast<size_t>(count->second.AsInt()),
+            radius == value.end() ? std::numeric_limits<double>::infinity() : radius->second.AsDouble());
+
+    request.StartDict()
+        .Key("request_id"sv).Value(id)
+        .Key("stops"sv).StartArray();
+    for (const StopIndex::Neighbour& stop : stops) {
+        request.StartDict()
+                .Key("distance"sv).Value(stop.distance)
+                .Key("name"sv).Value(catalog_.GetStop(stop.stop).name_)
+            .EndDict();
+    }
+    request.EndArray()
+        .EndDict();
 }
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once 
 
 #include "json.h"
-#include "json_builder.h"
+#include "json_writer.h"
 #include "map_renderer.h"
+#include "thread_pool.h"
 #include "transport_router.h"
 
+#include <memory>
+#include <mutex>
 #include <sstream>
 
 // Класс RequestHandler играет роль Фасада, упрощающего взаимодействие JSON reader-а 
@@ -13,20 +16,49 @@
 ////////// stat_requests //////////
 namespace request_handler {
     // играет роль Фасада, упрощающего взаимодействие JSON reader-а 
+    // const-методы обработки запросов можно вызывать из нескольких потоков одновременно:
+    // каталог и маршрутизатор только читаются, а карта выводится в SVG один раз под std::call_once
     class RequestHandler {
     public:
-        RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, const transport_router::RouterSettings& settings_router);
+        // с пулом потоков маршрутизатор строится параллельно
+        RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, const transport_router::RouterSettings& settings_router,
+                       thread_pool::ThreadPool* pool = nullptr);
+        // маршрутизатор восстанавливается из снимка базы без повторной предобработки
+        RequestHandler(const transport_catalogue::TransportCatalogue& catalog, const map_renderer::MapRender& map_catalog, transport_router::RouterSnapshot router_snapshot);
 
-        void RequestProcess(json::Array& value, svg::Document& map_svg, std::ostream& output);
+        // карта, отрисованная заранее (например, прочитанная из снимка базы); вызывается до первого запроса Map
+        void SetRenderedMap(std::string rendered_map);
+        // учёт изменений каталога между пакетами запросов (не параллельно с ними): маршрутизатор обновляется
+        // только в затронутой части; если карта изменилась (map_svg уже перерисован), её SVG выводится заново
+        // при следующем запросе Map
+        void Update(const transport_catalogue::CatalogueChanges& changes, bool is_map_changed,
+                    thread_pool::ThreadPool* pool = nullptr);
+
+        // обработка одного запроса; ответ сразу записывается в открытый массив request
+        void RequestProcess(const json::Dict& description, const svg::Document& map_svg, json::Writer& request) const;
+        // обработка пакета запросов; с пулом потоков пакет делится на части, которые обрабатываются параллельно,
+        // ответы всё равно записываются в открытый массив request в исходном порядке
+        void RequestProcess(const json::Array& requests, const svg::Document& map_svg, json::Writer& request, thread_pool::ThreadPool* pool) const;
 
     private:
-        transport_catalogue::TransportCatalogue catalog_;
-        map_renderer::MapRender map_catalog_;
+        // наибольшее число запросов в одной задаче пула потоков
+        static constexpr size_t MAX_CHUNK_SIZE = 256;
+
+        // каталог и карта не копируются: обработчик работает с неизменяемыми данными JsonReader
+        const transport_catalogue::TransportCatalogue& catalog_;
+        const map_renderer::MapRender& map_catalog_;
         transport_router::TransportRouter transport_router_;
+        // карта одинакова для всех запросов Map, поэтому выводится в SVG один раз;
+        // std::once_flag нельзя сбросить, поэтому при изменении карты Update создаёт новый
+        mutable std::unique_ptr<std::once_flag> map_rendered_ = std::make_unique<std::once_flag>();
+        mutable std::string rendered_map_;
 
-        void StopInfoPrint(const json::Dict& value, json::Builder& request);
-        void BusInfoPrint(const json::Dict& value, json::Builder& request);
-        void MapPrint(int id, svg::Document& map_svg, json::Builder& request);
-        void RoutePrint(const json::Dict& value, json::Builder& request);
+        void StopInfoPrint(const json::Dict& value, json::Writer& request) const;
+        void BusInfoPrint(const json::Dict& value, json::Writer& request) const;
+        void MapPrint(int id, const svg::Document& map_svg, json::Writer& request) const;
+        const std::string& GetRenderedMap(const svg::Document& map_svg) const;
+        void RoutePrint(const json::Dict& value, json::Writer& request) const;
+        void JourneyPrint(const json::Dict& value, json::Writer& request) const;
+        void NearestStopsPrint(const json::Dict& value, json::Writer& request) const;
     };
 } // namespace request_handler
\ No newline at end of file
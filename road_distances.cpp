@@ -0,0 +1,100 @@
+#include "road_distances.h"
+
+using namespace transport_catalogue;
+using namespace domain;
+
+// запись расстояния; таблица заполняется не более чем наполовину
+void RoadDistances::Set(StopId from, StopId to, double distance) {
+	const uint64_t key = MakeKey(from, to);
+	if (key == EMPTY_KEY) {
+		return;
+	}
+	if ((size_ + 1) * 2 > entries_.size()) {
+		Rehash(entries_.empty() ? MIN_CAPACITY : entries_.size() * 2);
+	}
+	Entry& entry = entries_[FindSlot(key)];
+	if (entry.key == EMPTY_KEY) {
+		entry.key = key;
+		++size_;
+	}
+	entry.distance = distance;
+}
+
+// удаление со сдвигом: записи той же цепочки пробирования за удалённой переносятся в освободившуюся ячейку,
+// поэтому поиск по-прежнему останавливается на первой пустой ячейке и обходится без надгробий
+bool RoadDistances::Erase(StopId from, StopId to) {
+	const uint64_t key = MakeKey(from, to);
+	if (entries_.empty() || key == EMPTY_KEY) {
+		return false;
+	}
+	const size_t mask = entries_.size() - 1;
+	size_t hole = FindSlot(key);
+	if (entries_[hole].key == EMPTY_KEY) {
+		return false;
+	}
+	for (size_t slot = (hole + 1) & mask; entries_[slot].key != EMPTY_KEY; slot = (slot + 1) & mask) {
+		// запись можно перенести, если её исходная ячейка не лежит в циклическом интервале (hole, slot]
+		const size_t home = Hash(entries_[slot].key) & mask;
+		if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+			entries_[hole] = entries_[slot];
+			hole = slot;
+		}
+	}
+	entries_[hole] = Entry{};
+	--size_;
+	return true;
+}
+
+// расстояние в прямом направлении, а если оно не задано — в обратном
+double RoadDistances::Get(StopId from, StopId to) const {
+	if (const double* distance = Find(from, to)) {
+		return *distance;
+	}
+	if (const double* distance = Find(to, from)) {
+		return *distance;
+	}
+	return 0;
+}
+
+const double* RoadDistances::Find(StopId from, StopId to) const {
+	const uint64_t key = MakeKey(from, to);
+	if (entries_.empty() || key == EMPTY_KEY) {
+		return nullptr;
+	}
+	const Entry& entry = entries_[FindSlot(key)];
+	return entry.key == EMPTY_KEY ? nullptr : &entry.distance;
+}
+
+size_t RoadDistances::GetSize() const {
+	return size_;
+}
+
+uint64_t RoadDistances::MakeKey(StopId from, StopId to) {
+	return uint64_t{from} << 32 | to;
+}
+
+// перемешивание ключа (финализатор splitmix64): соседние идентификаторы дают далёкие ячейки
+uint64_t RoadDistances::Hash(uint64_t key) {
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+	return key ^ (key >> 31);
+}
+
+size_t RoadDistances::FindSlot(uint64_t key) const {
+	const size_t mask = entries_.size() - 1;
+	size_t slot = Hash(key) & mask;
+	while (entries_[slot].key != EMPTY_KEY && entries_[slot].key != key) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void RoadDistances::Rehash(size_t capacity) {
+	std::vector<Entry> entries(capacity);
+	entries.swap(entries_);
+	for (const Entry& entry : entries) {
+		if (entry.key != EMPTY_KEY) {
+			entries_[FindSlot(entry.key)] = entry;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace transport_catalogue {
+	// таблица расстояний по дорогам между парами остановок.
+	// Открытая адресация с линейным пробированием по ключу из двух StopId: записи лежат в одном массиве,
+	// поиск обходится без выделения памяти и исключений
+	class RoadDistances {
+	public:
+		// запись расстояния from -> to; повторная запись заменяет значение
+		void Set(domain::StopId from, domain::StopId to, double distance);
+		// удаление расстояния from -> to; возвращает false, если оно не было задано
+		bool Erase(domain::StopId from, domain::StopId to);
+		// расстояние from -> to, если оно задано, иначе to -> from, иначе 0
+		double Get(domain::StopId from, domain::StopId to) const;
+		// заданное расстояние from -> to (nullptr, если оно не задано)
+		const double* Find(domain::StopId from, domain::StopId to) const;
+
+		size_t GetSize() const;
+		// обход всех заданных расстояний: function(from, to, distance)
+		template <typename Function>
+		void ForEach(Function function) const;
+
+	private:
+		struct Entry {
+			uint64_t key = EMPTY_KEY;
+			double distance = 0;
+		};
+
+		// ключ пустой ячейки; пара из двух наибольших StopId в каталоге не встречается
+		static constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+		// наименьшая ёмкость таблицы (степень двойки)
+		static constexpr size_t MIN_CAPACITY = 16;
+
+		std::vector<Entry> entries_;
+		size_t size_ = 0;
+
+		static uint64_t MakeKey(domain::StopId from, domain::StopId to);
+		static uint64_t Hash(uint64_t key);
+		// ячейка с ключом key или пустая ячейка, в которую его нужно записать
+		size_t FindSlot(uint64_t key) const;
+		void Rehash(size_t capacity);
+	};
+
+	template <typename Function>
+	void RoadDistances::ForEach(Function function) const {
+		for (const Entry& entry : entries_) {
+			if (entry.key != EMPTY_KEY) {
+				function(static_cast<domain::StopId>(entry.key >> 32), static_cast<domain::StopId>(entry.key), entry.distance);
+			}
+		}
+	}
+} // namespace transport_catalogue
\ No newline at end of file
@@ -1,12 +1,16 @@
 #pragma once
 
+#include "contraction_hierarchy.h"
 #include "graph.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <memory>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -14,13 +18,30 @@
 
 namespace graph {
 
+// режим работы маршрутизатора
+enum class RouterMode {
+    PRECOMPUTED,            // таблица кратчайших путей между всеми парами вершин (Флойд-Уоршелл), O(V^2) памяти
+    ON_DEMAND,              // поиск пути при каждом запросе (Дейкстра на двоичной куче), O(V) памяти
+    CONTRACTION_HIERARCHY   // предобработка иерархией сжатия и двунаправленный поиск при запросе
+};
+
 template <typename Weight>
 class Router {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    struct RouteInternalData {
+        Weight weight;
+        std::optional<EdgeId> prev_edge;
+    };
+    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    // с пулом потоков строки таблицы кратчайших путей (режим PRECOMPUTED) пересчитываются параллельно
+    explicit Router(const Graph& graph, RouterMode mode = RouterMode::PRECOMPUTED, thread_pool::ThreadPool* pool = nullptr);
+    // восстановление по результатам ранее выполненной предобработки
+    Router(const Graph& graph, RoutesInternalData routes_internal_data);
+    Router(const Graph& graph, std::unique_ptr<ContractionHierarchy<Weight>> hierarchy);
 
     struct RouteInfo {
         Weight weight;
@@ -28,26 +49,41 @@ public:
     };
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    // кратчайший путь из любой вершины sources в любую вершину targets с учётом их весов;
+    // строится за один поиск, а не отдельным BuildRoute для каждой пары
+    std::optional<TerminalRoute<Weight>> BuildRoute(const std::vector<Terminal<Weight>>& sources,
+                                                    const std::vector<Terminal<Weight>>& targets) const;
+
+    // учёт изменения рёбер графа, по которому построен маршрутизатор; новые вершины могут добавиться в конец.
+    // edge_ids пуст, если номера рёбер не изменились, иначе edge_ids[id] — новый номер неизменного ребра id
+    // прежнего графа или nullopt для удалённого и изменённого ребра; changed_edges — номера добавленных
+    // и изменённых рёбер в новом графе.
+    // PRECOMPUTED: заново считаются только строки таблицы, пути которых проходят через удалённое или изменённое ребро
+    // или могут сократиться через новое; ON_DEMAND: проверяются только веса; CONTRACTION_HIERARCHY: сокращения строятся
+    // заново в прежнем порядке сжатия, без повторного упорядочивания вершин
+    void Update(const std::vector<std::optional<EdgeId>>& edge_ids, const std::vector<EdgeId>& changed_edges,
+                thread_pool::ThreadPool* pool = nullptr);
+
+    RouterMode GetMode() const;
+    // таблица кратчайших путей (только в режиме PRECOMPUTED)
+    const RoutesInternalData& GetRoutesInternalData() const;
+    // иерархия сжатия (только в режиме CONTRACTION_HIERARCHY, иначе nullptr)
+    const ContractionHierarchy<Weight>* GetHierarchy() const;
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
             routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
             for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+                const Weight& edge_weight = graph.GetEdgeWeight(edge_id);
+                if (edge_weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                auto& route_internal_data = routes_internal_data_[vertex][graph.GetEdgeTo(edge_id)];
+                if (!route_internal_data || route_internal_data->weight > edge_weight) {
+                    route_internal_data = RouteInternalData{edge_weight, edge_id};
                 }
             }
         }
@@ -63,8 +99,11 @@ private:
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
+    // строки [from_begin, from_end) независимы при фиксированной vertex_through: строка vertex_through
+    // и столбец vertex_through на этом шаге не меняются, поэтому строки можно обрабатывать параллельно
+    void RelaxRoutesInternalDataThroughVertex(VertexId from_begin, VertexId from_end, VertexId vertex_through) {
+        const size_t vertex_count = routes_internal_data_.size();
+        for (VertexId vertex_from = from_begin; vertex_from < from_end; ++vertex_from) {
             if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
                 for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
                     if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
@@ -75,28 +114,213 @@ private:
         }
     }
 
+    void CheckEdgesWeights(const Graph& graph) const {
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    // строка from таблицы остаётся верной, если её пути не проходят через устаревшие рёбра
+    // и ни одно из новых рёбер не сокращает путь до своего конца (условие оптимальности кратчайших путей)
+    bool IsStaleRow(VertexId from, const std::vector<bool>& is_stale_edge, const std::vector<EdgeId>& changed_edges) const {
+        const auto& row = routes_internal_data_[from];
+        for (const auto& route : row) {
+            if (route && route->prev_edge && is_stale_edge[*route->prev_edge]) {
+                return true;
+            }
+        }
+        for (const EdgeId edge_id : changed_edges) {
+            const VertexId edge_from = graph_.GetEdgeFrom(edge_id);
+            const VertexId edge_to = graph_.GetEdgeTo(edge_id);
+            if (edge_from >= row.size() || !row[edge_from]) {
+                continue;
+            }
+            if (edge_to >= row.size() || !row[edge_to]
+                || row[edge_from]->weight + graph_.GetEdgeWeight(edge_id) < row[edge_to]->weight) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FillRoutesFrom(VertexId from, std::optional<VertexId> to, std::vector<std::optional<RouteInternalData>>& routes) const;
+    std::optional<RouteInfo> BuildPrecomputedRoute(VertexId from, VertexId to) const;
+    std::optional<RouteInfo> BuildOnDemandRoute(VertexId from, VertexId to) const;
+    std::optional<RouteInfo> BuildHierarchyRoute(VertexId from, VertexId to) const;
+    std::optional<TerminalRoute<Weight>> BuildPrecomputedRoute(const std::vector<Terminal<Weight>>& sources,
+                                                               const std::vector<Terminal<Weight>>& targets) const;
+    std::optional<TerminalRoute<Weight>> BuildOnDemandRoute(const std::vector<Terminal<Weight>>& sources,
+                                                            const std::vector<Terminal<Weight>>& targets) const;
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
+    RouterMode mode_;
     RoutesInternalData routes_internal_data_;
+    std::unique_ptr<ContractionHierarchy<Weight>> hierarchy_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, RouterMode mode, thread_pool::ThreadPool* pool)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , mode_(mode)
 {
-    InitializeRoutesInternalData(graph);
+    if (mode_ == RouterMode::ON_DEMAND) {
+        CheckEdgesWeights(graph);
+        return;
+    }
+    if (mode_ == RouterMode::CONTRACTION_HIERARCHY) {
+        hierarchy_ = std::make_unique<ContractionHierarchy<Weight>>(graph);
+        return;
+    }
 
     const size_t vertex_count = graph.GetVertexCount();
+    routes_internal_data_.assign(vertex_count, std::vector<std::optional<RouteInternalData>>(vertex_count));
+    InitializeRoutesInternalData(graph);
+
     for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+        thread_pool::ParallelFor(pool, vertex_count, [this, vertex_through](size_t from_begin, size_t from_end) {
+            RelaxRoutesInternalDataThroughVertex(from_begin, from_end, vertex_through);
+        });
     }
 }
 
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, RoutesInternalData routes_internal_data)
+    : graph_(graph)
+    , mode_(RouterMode::PRECOMPUTED)
+    , routes_internal_data_(std::move(routes_internal_data))
+{
+    const size_t vertex_count = graph.GetVertexCount();
+    if (routes_internal_data_.size() != vertex_count) {
+        throw std::invalid_argument("Routes table does not match the graph");
+    }
+    for (const auto& row : routes_internal_data_) {
+        if (row.size() != vertex_count) {
+            throw std::invalid_argument("Routes table does not match the graph");
+        }
+        for (const auto& route : row) {
+            if (route && route->prev_edge && *route->prev_edge >= graph.GetEdgeCount()) {
+                throw std::invalid_argument("Routes table does not match the graph");
+            }
+        }
+    }
+}
+
+template <typename Weight>
+Router<Weight>::Router(const Graph& graph, std::unique_ptr<ContractionHierarchy<Weight>> hierarchy)
+    : graph_(graph)
+    , mode_(RouterMode::CONTRACTION_HIERARCHY)
+    , hierarchy_(std::move(hierarchy))
+{
+}
+
+template <typename Weight>
+void Router<Weight>::Update(const std::vector<std::optional<EdgeId>>& edge_ids, const std::vector<EdgeId>& changed_edges,
+                            thread_pool::ThreadPool* pool) {
+    for (const EdgeId edge_id : changed_edges) {
+        if (graph_.GetEdgeWeight(edge_id) < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    if (mode_ == RouterMode::ON_DEMAND) {
+        return;
+    }
+    if (mode_ == RouterMode::CONTRACTION_HIERARCHY) {
+        hierarchy_ = std::make_unique<ContractionHierarchy<Weight>>(graph_, hierarchy_->GetRanks());
+        return;
+    }
+
+    // устаревшие рёбра — в нумерации прежнего графа, на которую ссылается таблица
+    std::vector<bool> is_stale_edge;
+    if (edge_ids.empty()) {
+        is_stale_edge.assign(graph_.GetEdgeCount(), false);
+        for (const EdgeId edge_id : changed_edges) {
+            is_stale_edge[edge_id] = true;
+        }
+    }
+    else {
+        is_stale_edge.resize(edge_ids.size());
+        for (EdgeId edge_id = 0; edge_id < edge_ids.size(); ++edge_id) {
+            is_stale_edge[edge_id] = !edge_ids[edge_id];
+        }
+    }
+
+    // строки новых вершин считаются целиком; char вместо bool, чтобы потоки писали в разные байты
+    const size_t old_vertex_count = routes_internal_data_.size();
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<char> is_stale_row(vertex_count, 1);
+    thread_pool::ParallelFor(pool, old_vertex_count, [this, &is_stale_row, &is_stale_edge, &changed_edges](size_t begin, size_t end) {
+        for (VertexId from = begin; from < end; ++from) {
+            is_stale_row[from] = IsStaleRow(from, is_stale_edge, changed_edges);
+        }
+    });
+
+    for (auto& row : routes_internal_data_) {
+        row.resize(vertex_count);
+    }
+    routes_internal_data_.resize(vertex_count, std::vector<std::optional<RouteInternalData>>(vertex_count));
+    thread_pool::ParallelFor(pool, vertex_count, [this, &is_stale_row, &edge_ids](size_t begin, size_t end) {
+        for (VertexId from = begin; from < end; ++from) {
+            auto& row = routes_internal_data_[from];
+            if (is_stale_row[from]) {
+                row.assign(row.size(), std::nullopt);
+                FillRoutesFrom(from, std::nullopt, row);
+            }
+            else if (!edge_ids.empty()) {
+                for (auto& route : row) {
+                    if (route && route->prev_edge) {
+                        route->prev_edge = edge_ids[*route->prev_edge];
+                    }
+                }
+            }
+        }
+    });
+}
+
+template <typename Weight>
+RouterMode Router<Weight>::GetMode() const {
+    return mode_;
+}
+
+template <typename Weight>
+const typename Router<Weight>::RoutesInternalData& Router<Weight>::GetRoutesInternalData() const {
+    return routes_internal_data_;
+}
+
+template <typename Weight>
+const ContractionHierarchy<Weight>* Router<Weight>::GetHierarchy() const {
+    return hierarchy_.get();
+}
+
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
+    if (mode_ == RouterMode::ON_DEMAND) {
+        return BuildOnDemandRoute(from, to);
+    }
+    if (mode_ == RouterMode::CONTRACTION_HIERARCHY) {
+        return BuildHierarchyRoute(from, to);
+    }
+    return BuildPrecomputedRoute(from, to);
+}
+
+template <typename Weight>
+std::optional<TerminalRoute<Weight>> Router<Weight>::BuildRoute(const std::vector<Terminal<Weight>>& sources,
+                                                                const std::vector<Terminal<Weight>>& targets) const {
+    if (mode_ == RouterMode::ON_DEMAND) {
+        return BuildOnDemandRoute(sources, targets);
+    }
+    if (mode_ == RouterMode::CONTRACTION_HIERARCHY) {
+        return hierarchy_->BuildRoute(sources, targets);
+    }
+    return BuildPrecomputedRoute(sources, targets);
+}
+
+template <typename Weight>
+std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildPrecomputedRoute(VertexId from,
+                                                                                        VertexId to) const {
     const auto& route_internal_data = routes_internal_data_.at(from).at(to);
     if (!route_internal_data) {
         return std::nullopt;
@@ -105,7 +329,57 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     std::vector<EdgeId> edges;
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_internal_data_[from][graph_.GetEdgeFrom(*edge_id)]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return RouteInfo{weight, std::move(edges)};
+}
+
+// перебор пар по таблице: O(|sources| * |targets|) без обхода графа
+template <typename Weight>
+std::optional<TerminalRoute<Weight>> Router<Weight>::BuildPrecomputedRoute(const std::vector<Terminal<Weight>>& sources,
+                                                                           const std::vector<Terminal<Weight>>& targets) const {
+    std::optional<TerminalRoute<Weight>> best;
+    for (const Terminal<Weight>& source : sources) {
+        for (const Terminal<Weight>& target : targets) {
+            const auto& route_internal_data = routes_internal_data_.at(source.vertex).at(target.vertex);
+            if (!route_internal_data) {
+                continue;
+            }
+            const Weight weight = source.weight + route_internal_data->weight + target.weight;
+            if (!best || weight < best->weight) {
+                best = TerminalRoute<Weight>{source.vertex, target.vertex, weight, {}};
+            }
+        }
+    }
+    if (best) {
+        best->edges = std::move(BuildPrecomputedRoute(best->from, best->to)->edges);
+    }
+    return best;
+}
+
+template <typename Weight>
+std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildOnDemandRoute(VertexId from,
+                                                                                     VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+
+    std::vector<std::optional<RouteInternalData>> routes(vertex_count);
+    FillRoutesFrom(from, to, routes);
+
+    if (!routes[to]) {
+        return std::nullopt;
+    }
+    const Weight weight = routes[to]->weight;
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = routes[to]->prev_edge;
+         edge_id;
+         edge_id = routes[graph_.GetEdgeFrom(*edge_id)]->prev_edge)
     {
         edges.push_back(*edge_id);
     }
@@ -114,4 +388,140 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+// Дейкстра на двоичной куче из вершины from; routes — по пустому пути до каждой вершины графа.
+// Если задана вершина to, поиск останавливается, как только путь до неё найден
+template <typename Weight>
+void Router<Weight>::FillRoutesFrom(VertexId from, std::optional<VertexId> to,
+                                    std::vector<std::optional<RouteInternalData>>& routes) const {
+    std::vector<bool> visited(graph_.GetVertexCount(), false);
+
+    // куча вершин, упорядоченная по возрастанию веса пути до них
+    using QueueItem = std::pair<Weight, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return rhs.first < lhs.first;
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)> queue(greater);
+
+    routes[from] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+    queue.emplace(ZERO_WEIGHT, from);
+
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        queue.pop();
+        if (visited[vertex]) {
+            continue;
+        }
+        visited[vertex] = true;
+        if (to && vertex == *to) {
+            break;
+        }
+
+        const Weight& vertex_weight = routes[vertex]->weight;
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const VertexId edge_to = graph_.GetEdgeTo(edge_id);
+            if (visited[edge_to]) {
+                continue;
+            }
+            const Weight candidate_weight = vertex_weight + graph_.GetEdgeWeight(edge_id);
+            auto& route_relaxing = routes[edge_to];
+            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
+                route_relaxing = RouteInternalData{candidate_weight, edge_id};
+                queue.emplace(candidate_weight, edge_to);
+            }
+        }
+    }
+}
+
+// Дейкстра из всех начальных вершин сразу; поиск останавливается, когда вес пути до очередной вершины
+// не меньше лучшего найденного пути с учётом веса конечной вершины
+template <typename Weight>
+std::optional<TerminalRoute<Weight>> Router<Weight>::BuildOnDemandRoute(const std::vector<Terminal<Weight>>& sources,
+                                                                        const std::vector<Terminal<Weight>>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    std::vector<std::optional<RouteInternalData>> routes(vertex_count);
+    std::vector<std::optional<Weight>> target_weights(vertex_count);
+    std::vector<bool> visited(vertex_count, false);
+
+    using QueueItem = std::pair<Weight, VertexId>;
+    auto greater = [](const QueueItem& lhs, const QueueItem& rhs) {
+        return rhs.first < lhs.first;
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, decltype(greater)> queue(greater);
+
+    for (const Terminal<Weight>& target : targets) {
+        auto& target_weight = target_weights.at(target.vertex);
+        if (!target_weight || target.weight < *target_weight) {
+            target_weight = target.weight;
+        }
+    }
+    for (const Terminal<Weight>& source : sources) {
+        auto& route = routes.at(source.vertex);
+        if (!route || source.weight < route->weight) {
+            route = RouteInternalData{source.weight, std::nullopt};
+            queue.emplace(source.weight, source.vertex);
+        }
+    }
+
+    std::optional<Weight> best_weight;
+    VertexId best_vertex = 0;
+    while (!queue.empty()) {
+        const VertexId vertex = queue.top().second;
+        if (best_weight && !(queue.top().first < *best_weight)) {
+            break;
+        }
+        queue.pop();
+        if (visited[vertex]) {
+            continue;
+        }
+        visited[vertex] = true;
+
+        const Weight& vertex_weight = routes[vertex]->weight;
+        if (const auto& target_weight = target_weights[vertex]) {
+            const Weight weight = vertex_weight + *target_weight;
+            if (!best_weight || weight < *best_weight) {
+                best_weight = weight;
+                best_vertex = vertex;
+            }
+        }
+        for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+            const VertexId edge_to = graph_.GetEdgeTo(edge_id);
+            if (visited[edge_to]) {
+                continue;
+            }
+            const Weight candidate_weight = vertex_weight + graph_.GetEdgeWeight(edge_id);
+            auto& route_relaxing = routes[edge_to];
+            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
+                route_relaxing = RouteInternalData{candidate_weight, edge_id};
+                queue.emplace(candidate_weight, edge_to);
+            }
+        }
+    }
+
+    if (!best_weight) {
+        return std::nullopt;
+    }
+    VertexId from = best_vertex;
+    std::vector<EdgeId> edges;
+    for (std::optional<EdgeId> edge_id = routes[best_vertex]->prev_edge;
+         edge_id;
+         edge_id = routes[from]->prev_edge)
+    {
+        edges.push_back(*edge_id);
+        from = graph_.GetEdgeFrom(*edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+
+    return TerminalRoute<Weight>{from, best_vertex, *best_weight, std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildHierarchyRoute(VertexId from,
+                                                                                      VertexId to) const {
+    auto route = hierarchy_->BuildRoute(from, to);
+    if (!route) {
+        return std::nullopt;
+    }
+    return RouteInfo{route->weight, std::move(route->edges)};
+}
+
 }  // namespace graph
\ No newline at end of file
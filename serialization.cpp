@@ -0,0 +1,322 @@
+#include "serialization.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace serialization;
+using namespace transport_catalogue;
+using namespace transport_router;
+using namespace std::literals;
+
+namespace {
+    using Graph = graph::DirectedWeightedGraph<RouteWeight>;
+    using RouteInternalData = std::optional<graph::Router<RouteWeight>::RouteInternalData>;
+    using HierarchyEdge = graph::ContractionHierarchy<RouteWeight>::HierarchyEdge;
+
+    static_assert(std::is_trivially_copyable_v<RouteWeight>);
+    static_assert(std::is_trivially_copyable_v<RouteInternalData>);
+    static_assert(std::is_trivially_copyable_v<HierarchyEdge>);
+
+    struct DistanceRecord {
+        uint32_t from;
+        uint32_t to;
+        double distance;
+    };
+
+    // последовательная запись значений и массивов тривиально копируемых типов
+    class SnapshotWriter {
+    public:
+        explicit SnapshotWriter(std::ostream& output)
+            : output_(output) {
+        }
+
+        template <typename T>
+        void Write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            output_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <typename T>
+        void WriteArray(const T* data, size_t size) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Write<uint64_t>(size);
+            output_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(sizeof(T) * size));
+        }
+
+        template <typename T>
+        void WriteArray(const std::vector<T>& values) {
+            WriteArray(values.data(), values.size());
+        }
+
+        void WriteString(std::string_view value) {
+            WriteArray(value.data(), value.size());
+        }
+
+    private:
+        std::ostream& output_;
+    };
+
+    // чтение из буфера с проверкой границ: повреждённый снимок даёт SnapshotError, а не выход за буфер
+    class SnapshotReader {
+    public:
+        explicit SnapshotReader(std::string_view data)
+            : data_(data) {
+        }
+
+        template <typename T>
+        T Read() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Require(sizeof(T));
+            T value;
+            std::memcpy(&value, data_.data() + pos_, sizeof(T));
+            pos_ += sizeof(T);
+            return value;
+        }
+
+        template <typename T>
+        std::vector<T> ReadArray() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const uint64_t size = ReadSize(sizeof(T));
+            std::vector<T> values(size);
+            if (size > 0) {
+                std::memcpy(values.data(), data_.data() + pos_, sizeof(T) * size);
+            }
+            pos_ += sizeof(T) * size;
+            return values;
+        }
+
+        // строка указывает в буфер снимка и действительна, пока жив буфер
+        std::string_view ReadString() {
+            const uint64_t size = ReadSize(1);
+            std::string_view value = data_.substr(pos_, size);
+            pos_ += size;
+            return value;
+        }
+
+        // размер следующего массива; не больше числа элементов, оставшихся в буфере
+        uint64_t ReadSize(size_t element_size) {
+            const uint64_t size = Read<uint64_t>();
+            if (size > (data_.size() - pos_) / element_size) {
+                throw SnapshotError("Snapshot is truncated"s);
+            }
+            return size;
+        }
+
+        bool IsEnd() const {
+            return pos_ == data_.size();
+        }
+
+    private:
+        std::string_view data_;
+        size_t pos_ = 0;
+
+        void Require(size_t size) const {
+            if (data_.size() - pos_ < size) {
+                throw SnapshotError("Snapshot is truncated"s);
+            }
+        }
+    };
+
+    // чтение всего потока в буфер одним вызовом, если размер известен
+    std::string ReadAll(std::istream& input) {
+        std::string buffer;
+        input.seekg(0, std::ios::end);
+        const std::streamoff size = input.tellg();
+        input.seekg(0, std::ios::beg);
+        if (size > 0) {
+            buffer.resize(static_cast<size_t>(size));
+            input.read(buffer.data(), size);
+            buffer.resize(static_cast<size_t>(input.gcount()));
+            return buffer;
+        }
+        input.clear();
+        char chunk[1 << 16];
+        while (input.read(chunk, sizeof(chunk)) || input.gcount() > 0) {
+            buffer.append(chunk, static_cast<size_t>(input.gcount()));
+        }
+        return buffer;
+    }
+
+    void SaveCatalogue(SnapshotWriter& writer, const TransportCatalogue& catalogue) {
+        // остановки и маршруты записываются в порядке идентификаторов и при чтении получают те же StopId и BusId,
+        // на которые ссылаются рёбра графа маршрутизатора; удалённые в этом формате не представимы
+        for (StopId id = 0; id < catalogue.GetStopCount(); ++id) {
+            if (catalogue.IsStopRemoved(id)) {
+                throw std::invalid_argument("Catalogue with removed stops cannot be saved"s);
+            }
+        }
+        for (BusId id = 0; id < catalogue.GetBusCount(); ++id) {
+            if (catalogue.IsBusRemoved(id)) {
+                throw std::invalid_argument("Catalogue with removed buses cannot be saved"s);
+            }
+        }
+        writer.Write<uint64_t>(catalogue.GetStopCount());
+        for (StopId id = 0; id < catalogue.GetStopCount(); ++id) {
+            const Stop& stop = catalogue.GetStop(id);
+            writer.WriteString(stop.name_);
+            writer.Write(stop.coordinates_.lat);
+            writer.Write(stop.coordinates_.lng);
+        }
+
+        writer.Write<uint64_t>(catalogue.GetBusCount());
+        for (BusId id = 0; id < catalogue.GetBusCount(); ++id) {
+            const Bus& bus = catalogue.GetBus(id);
+            writer.WriteString(bus.name_);
+            writer.Write<uint8_t>(bus.loop_ == RouteType::IS_LOOPED);
+            writer.WriteArray(bus.stops_of_bus_);
+        }
+
+        std::vector<DistanceRecord> distances;
+        distances.reserve(catalogue.GetDistances().GetSize());
+        catalogue.GetDistances().ForEach([&distances](StopId from, StopId to, double distance) {
+            distances.push_back({ from, to, distance });
+        });
+        writer.WriteArray(distances);
+    }
+
+    void LoadCatalogue(SnapshotReader& reader, TransportCatalogue& catalogue) {
+        const uint64_t stops_count = reader.ReadSize(sizeof(uint64_t));
+        for (uint64_t i = 0; i < stops_count; ++i) {
+            const std::string_view name = reader.ReadString();
+            const double lat = reader.Read<double>();
+            const double lng = reader.Read<double>();
+            catalogue.AddStop(name, { lat, lng });
+        }
+        auto check_stop = [&catalogue](StopId id) {
+            if (id >= catalogue.GetStopCount()) {
+                throw SnapshotError("Snapshot refers to an unknown stop"s);
+            }
+            return id;
+        };
+
+        const uint64_t buses_count = reader.ReadSize(sizeof(uint64_t));
+        for (uint64_t i = 0; i < buses_count; ++i) {
+            const std::string_view name = reader.ReadString();
+            const RouteType loop = reader.Read<uint8_t>() ? RouteType::IS_LOOPED : RouteType::NOT_LOOPED;
+            std::vector<StopId> bus_stops = reader.ReadArray<StopId>();
+            for (StopId id : bus_stops) {
+                check_stop(id);
+            }
+            catalogue.AddBus(name, std::move(bus_stops), loop);
+        }
+
+        for (const DistanceRecord& record : reader.ReadArray<DistanceRecord>()) {
+            catalogue.SetDistanceBetweenStops(check_stop(record.from), check_stop(record.to), record.distance);
+        }
+    }
+
+    void SaveRouter(SnapshotWriter& writer, const TransportRouter& router) {
+        const RouterSettings& settings = router.GetSettings();
+        const graph::Router<RouteWeight>& graph_router = router.GetRouter();
+        writer.Write<uint64_t>(settings.bus_wait_time);
+        writer.Write(settings.bus_velocity);
+        writer.Write(settings.walking_velocity);
+        writer.Write(settings.max_walking_distance);
+        writer.Write(static_cast<uint8_t>(settings.graph_model));
+        writer.Write(static_cast<uint8_t>(graph_router.GetMode()));
+
+        const Graph& graph = router.GetGraph();
+        const size_t edge_count = graph.GetEdgeCount();
+        std::vector<graph::VertexId> edges_from(edge_count);
+        std::vector<graph::VertexId> edges_to(edge_count);
+        std::vector<RouteWeight> edges_weight(edge_count);
+        for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            edges_from[edge_id] = graph.GetEdgeFrom(edge_id);
+            edges_to[edge_id] = graph.GetEdgeTo(edge_id);
+            edges_weight[edge_id] = graph.GetEdgeWeight(edge_id);
+        }
+        writer.Write<uint64_t>(graph.GetVertexCount());
+        writer.WriteArray(edges_from);
+        writer.WriteArray(edges_to);
+        writer.WriteArray(edges_weight);
+
+        if (graph_router.GetMode() == graph::RouterMode::PRECOMPUTED) {
+            for (const auto& row : graph_router.GetRoutesInternalData()) {
+                writer.WriteArray(row);
+            }
+        }
+        else if (graph_router.GetMode() == graph::RouterMode::CONTRACTION_HIERARCHY) {
+            writer.WriteArray(graph_router.GetHierarchy()->GetEdges());
+            writer.WriteArray(graph_router.GetHierarchy()->GetRanks());
+        }
+    }
+
+    RouterSnapshot LoadRouter(SnapshotReader& reader) {
+        RouterSnapshot snapshot;
+        snapshot.settings.bus_wait_time = reader.Read<uint64_t>();
+        snapshot.settings.bus_velocity = reader.Read<float>();
+        snapshot.settings.walking_velocity = reader.Read<float>();
+        snapshot.settings.max_walking_distance = reader.Read<double>();
+        const uint8_t graph_model = reader.Read<uint8_t>();
+        const uint8_t router_mode = reader.Read<uint8_t>();
+        if (graph_model > static_cast<uint8_t>(GraphModel::BOARDING)
+            || router_mode > static_cast<uint8_t>(graph::RouterMode::CONTRACTION_HIERARCHY)) {
+            throw SnapshotError("Snapshot has unknown router settings"s);
+        }
+        snapshot.settings.graph_model = static_cast<GraphModel>(graph_model);
+        snapshot.settings.router_mode = static_cast<graph::RouterMode>(router_mode);
+
+        const uint64_t vertex_count = reader.Read<uint64_t>();
+        const std::vector<graph::VertexId> edges_from = reader.ReadArray<graph::VertexId>();
+        const std::vector<graph::VertexId> edges_to = reader.ReadArray<graph::VertexId>();
+        const std::vector<RouteWeight> edges_weight = reader.ReadArray<RouteWeight>();
+        if (edges_to.size() != edges_from.size() || edges_weight.size() != edges_from.size()) {
+            throw SnapshotError("Snapshot has inconsistent graph edges"s);
+        }
+        snapshot.graph = Graph(vertex_count);
+        for (size_t i = 0; i < edges_from.size(); ++i) {
+            if (edges_from[i] >= vertex_count || edges_to[i] >= vertex_count) {
+                throw SnapshotError("Snapshot refers to an unknown vertex"s);
+            }
+            snapshot.graph.AddEdge({ edges_from[i], edges_to[i], edges_weight[i] });
+        }
+
+        if (snapshot.settings.router_mode == graph::RouterMode::PRECOMPUTED) {
+            snapshot.routes_internal_data.reserve(vertex_count);
+            for (uint64_t i = 0; i < vertex_count; ++i) {
+                snapshot.routes_internal_data.push_back(reader.ReadArray<RouteInternalData>());
+            }
+        }
+        else if (snapshot.settings.router_mode == graph::RouterMode::CONTRACTION_HIERARCHY) {
+            snapshot.hierarchy_edges = reader.ReadArray<HierarchyEdge>();
+            snapshot.hierarchy_ranks = reader.ReadArray<size_t>();
+        }
+        return snapshot;
+    }
+} // namespace
+
+void serialization::SaveBase(std::ostream& output, const TransportCatalogue& catalogue,
+                             const std::string& rendered_map, const TransportRouter& router) {
+    SnapshotWriter writer(output);
+    writer.Write(SNAPSHOT_MAGIC);
+    writer.Write(SNAPSHOT_VERSION);
+    SaveCatalogue(writer, catalogue);
+    writer.WriteString(rendered_map);
+    SaveRouter(writer, router);
+    if (!output) {
+        throw std::runtime_error("Failed to write snapshot"s);
+    }
+}
+
+BaseSnapshot serialization::LoadBase(std::istream& input, TransportCatalogue& catalogue) {
+    const std::string buffer = ReadAll(input);
+    SnapshotReader reader(buffer);
+    if (reader.Read<uint32_t>() != SNAPSHOT_MAGIC) {
+        throw SnapshotError("Not a transport catalogue snapshot"s);
+    }
+    if (const uint32_t version = reader.Read<uint32_t>(); version != SNAPSHOT_VERSION) {
+        throw SnapshotError("Unsupported snapshot version "s + std::to_string(version));
+    }
+
+    BaseSnapshot snapshot;
+    LoadCatalogue(reader, catalogue);
+    snapshot.rendered_map = std::string(reader.ReadString());
+    snapshot.router = LoadRouter(reader);
+    if (!reader.IsEnd()) {
+        throw SnapshotError("Snapshot has trailing data"s);
+    }
+    return snapshot;
+}
\ No newline at end of file
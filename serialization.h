@@ -0,0 +1,49 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+
+// Двоичный снимок базы: каталог, отрисованная карта, граф и таблицы маршрутизатора.
+// Снимок создаётся режимом make_base и читается режимом process_requests,
+// чтобы не разбирать base_requests и не выполнять предобработку маршрутизатора при каждом запуске.
+//
+// Формат (порядок байтов и размеры типов — как у платформы, на которой снимок создан):
+//   заголовок     uint32 SNAPSHOT_MAGIC, uint32 SNAPSHOT_VERSION
+//   остановки     uint64 n, n x { строка name, double lat, double lng }
+//   маршруты      uint64 n, n x { строка name, uint8 is_roundtrip, массив uint32 индексов остановок }
+//   дистанции     массив { uint32 from, uint32 to, double distance }
+//   карта         строка SVG
+//   маршрутизатор uint64 bus_wait_time, float bus_velocity, float walking_velocity, double max_walking_distance,
+//                 uint8 graph_model, uint8 router_mode,
+//                 uint64 vertex_count, массивы from, to, weight рёбер графа,
+//                 для PRECOMPUTED — vertex_count массивов строк таблицы кратчайших путей,
+//                 для CONTRACTION_HIERARCHY — массивы рёбер иерархии и рангов вершин
+// Массив и строка записываются как uint64 размер и следующие за ним элементы.
+namespace serialization {
+    inline constexpr uint32_t SNAPSHOT_MAGIC = 0x54435342; // "TCSB"
+    // версия формата; увеличивается при любом изменении раскладки данных
+    inline constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    // ошибка чтения снимка: чужой или повреждённый файл, другая версия формата
+    class SnapshotError : public std::runtime_error {
+    public:
+        using runtime_error::runtime_error;
+    };
+
+    // часть снимка, которая не хранится в каталоге
+    struct BaseSnapshot {
+        std::string rendered_map;
+        transport_router::RouterSnapshot router;
+    };
+
+    void SaveBase(std::ostream& output, const transport_catalogue::TransportCatalogue& catalogue,
+                  const std::string& rendered_map, const transport_router::TransportRouter& router);
+
+    // каталог должен быть пустым; после чтения в нём нужно вызвать BuildBusesInfo
+    BaseSnapshot LoadBase(std::istream& input, transport_catalogue::TransportCatalogue& catalogue);
+} // namespace serialization
\ No newline at end of file
@@ -0,0 +1,172 @@
+#define _USE_MATH_DEFINES
+#include "stop_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+
+using namespace transport_catalogue;
+using namespace domain;
+
+namespace {
+	double SquaredChord(const double (&lhs)[3], const double (&rhs)[3]) {
+		const double dx = lhs[0] - rhs[0];
+		const double dy = lhs[1] - rhs[1];
+		const double dz = lhs[2] - rhs[2];
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	// квадрат хорды единичной сферы для дуги distance метров
+	double SquaredChordForDistance(double distance) {
+		const double angle = distance / geo::EARTH_RADIUS;
+		if (!(angle < M_PI)) {
+			// дальше половины окружности ничего нет: подходит любая точка сферы
+			return std::numeric_limits<double>::infinity();
+		}
+		const double chord = 2 * std::sin(angle / 2);
+		return chord * chord;
+	}
+
+	double DistanceForSquaredChord(double squared_chord) {
+		return 2 * geo::EARTH_RADIUS * std::asin(std::min(1., std::sqrt(squared_chord) / 2));
+	}
+} // namespace
+
+// куча лучших кандидатов: на вершине худший из них
+class StopIndex::Candidates {
+public:
+	Candidates(size_t count, double bound)
+		: count_(count)
+		, bound_(bound) {
+	}
+
+	void Offer(double squared_chord, StopId stop) {
+		if (squared_chord > bound_) {
+			return;
+		}
+		if (heap_.size() < count_) {
+			heap_.emplace(squared_chord, stop);
+		}
+		else if (std::make_pair(squared_chord, stop) < heap_.top()) {
+			heap_.pop();
+			heap_.emplace(squared_chord, stop);
+		}
+	}
+
+	// квадрат хорды, дальше которого кандидаты уже не нужны
+	double GetBound() const {
+		return heap_.size() < count_ ? bound_ : std::min(bound_, heap_.top().first);
+	}
+
+	std::vector<Neighbour> Extract() {
+		std::vector<Neighbour> result(heap_.size());
+		for (auto it = result.rbegin(); it != result.rend(); ++it) {
+			*it = { heap_.top().second, DistanceForSquaredChord(heap_.top().first) };
+			heap_.pop();
+		}
+		return result;
+	}
+
+private:
+	size_t count_;
+	double bound_;
+	std::priority_queue<std::pair<double, StopId>> heap_;
+};
+
+StopIndex::StopIndex(const geo::CoordinateArrays& coordinates) {
+	points_.reserve(coordinates.GetSize());
+	for (StopId id = 0; id < coordinates.GetSize(); ++id) {
+		points_.push_back(MakePoint(coordinates.Get(id), id));
+	}
+	axes_.resize(points_.size());
+	Build(0, points_.size());
+}
+
+StopIndex::StopIndex(const geo::CoordinateArrays& coordinates, const std::vector<StopId>& stops) {
+	points_.reserve(stops.size());
+	for (StopId id : stops) {
+		points_.push_back(MakePoint(coordinates.Get(id), id));
+	}
+	axes_.resize(points_.size());
+	Build(0, points_.size());
+}
+
+std::vector<StopIndex::Neighbour> StopIndex::FindNearest(geo::Coordinates point, size_t count, double max_distance) const {
+	if (count == 0 || points_.empty() || max_distance < 0) {
+		return {};
+	}
+	Candidates candidates(count, SquaredChordForDistance(max_distance));
+	Search(0, points_.size(), MakePoint(point, 0), candidates);
+	return candidates.Extract();
+}
+
+std::vector<StopIndex::Neighbour> StopIndex::FindWithin(geo::Coordinates point, double radius) const {
+	return FindNearest(point, points_.size(), radius);
+}
+
+size_t StopIndex::GetSize() const {
+	return points_.size();
+}
+
+// точка единичной сферы
+StopIndex::Point StopIndex::MakePoint(geo::Coordinates coordinates, StopId stop) {
+	const double lat = coordinates.lat * M_PI / 180.;
+	const double lng = coordinates.lng * M_PI / 180.;
+	return { { std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat) }, stop };
+}
+
+// разбиение по оси наибольшего разброса, в середину диапазона ставится медиана
+void StopIndex::Build(size_t begin, size_t end) {
+	if (end - begin < 2) {
+		return;
+	}
+	double low[3] = { points_[begin].position[0], points_[begin].position[1], points_[begin].position[2] };
+	double high[3] = { low[0], low[1], low[2] };
+	for (size_t i = begin + 1; i < end; ++i) {
+		for (int axis = 0; axis < 3; ++axis) {
+			low[axis] = std::min(low[axis], points_[i].position[axis]);
+			high[axis] = std::max(high[axis], points_[i].position[axis]);
+		}
+	}
+	uint8_t axis = 0;
+	for (uint8_t i = 1; i < 3; ++i) {
+		if (high[i] - low[i] > high[axis] - low[axis]) {
+			axis = i;
+		}
+	}
+
+	const size_t middle = begin + (end - begin) / 2;
+	std::nth_element(points_.begin() + begin, points_.begin() + middle, points_.begin() + end,
+		[axis](const Point& lhs, const Point& rhs) {
+			return lhs.position[axis] < rhs.position[axis];
+		});
+	axes_[middle] = axis;
+	Build(begin, middle);
+	Build(middle + 1, end);
+}
+
+// сначала обходится поддерево со стороны target; второе — только если слой разбиения ближе худшего кандидата
+void StopIndex::Search(size_t begin, size_t end, const Point& target, Candidates& candidates) const {
+	if (begin == end) {
+		return;
+	}
+	const size_t middle = begin + (end - begin) / 2;
+	const Point& point = points_[middle];
+	candidates.Offer(SquaredChord(point.position, target.position), point.stop);
+
+	const uint8_t axis = axes_[middle];
+	const double difference = target.position[axis] - point.position[axis];
+	if (difference < 0) {
+		Search(begin, middle, target, candidates);
+		if (difference * difference <= candidates.GetBound()) {
+			Search(middle + 1, end, target, candidates);
+		}
+	}
+	else {
+		Search(middle + 1, end, target, candidates);
+		if (difference * difference <= candidates.GetBound()) {
+			Search(begin, middle, target, candidates);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace transport_catalogue {
+	// пространственный индекс остановок: k-d дерево по точкам единичной сферы.
+	// Длина хорды между точками сферы растёт вместе с расстоянием по дуге большого круга, поэтому
+	// отсечение поддеревьев по евклидову расстоянию в трёхмерном пространстве даёт точный ответ
+	// без проекции на плоскость и без особых случаев у полюсов и линии перемены дат
+	class StopIndex {
+	public:
+		// найденная остановка и расстояние до неё по дуге большого круга, в метрах
+		struct Neighbour {
+			domain::StopId stop = 0;
+			double distance = 0;
+		};
+
+		StopIndex() = default;
+		// coordinates.Get(id) — координаты остановки с идентификатором id
+		explicit StopIndex(const geo::CoordinateArrays& coordinates);
+		// индекс только по остановкам stops
+		StopIndex(const geo::CoordinateArrays& coordinates, const std::vector<domain::StopId>& stops);
+
+		// не более count ближайших остановок не дальше max_distance метров,
+		// по возрастанию расстояния (при равенстве — по возрастанию StopId)
+		std::vector<Neighbour> FindNearest(geo::Coordinates point, size_t count,
+			double max_distance = std::numeric_limits<double>::infinity()) const;
+		// все остановки не дальше radius метров, в том же порядке
+		std::vector<Neighbour> FindWithin(geo::Coordinates point, double radius) const;
+
+		size_t GetSize() const;
+
+	private:
+		struct Point {
+			double position[3];
+			domain::StopId stop;
+		};
+		// лучшие найденные остановки (определение в stop_index.cpp)
+		class Candidates;
+
+		// вершины неявного сбалансированного дерева: корень поддиапазона [begin, end) лежит в его середине,
+		// левое поддерево — до середины, правое — после
+		std::vector<Point> points_;
+		// ось разбиения в каждой вершине
+		std::vector<uint8_t> axes_;
+
+		static Point MakePoint(geo::Coordinates coordinates, domain::StopId stop);
+		void Build(size_t begin, size_t end);
+		void Search(size_t begin, size_t end, const Point& target, Candidates& candidates) const;
+	};
+} // namespace transport_catalogue
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "string_pool.h"
+
+#include <cstring>
+#include <functional>
+
+using namespace transport_catalogue;
+
+// индекс заполняется не более чем наполовину
+std::string_view StringPool::Intern(std::string_view value) {
+	if ((size_ + 1) * 2 > index_.size()) {
+		Rehash(index_.empty() ? MIN_INDEX_CAPACITY : index_.size() * 2);
+	}
+	std::string_view& slot = index_[FindSlot(value)];
+	if (slot.data() != nullptr) {
+		return slot;
+	}
+	char* data = Allocate(value.size());
+	if (!value.empty()) {
+		std::memcpy(data, value.data(), value.size());
+	}
+	slot = std::string_view(data, value.size());
+	++size_;
+	return slot;
+}
+
+std::string_view StringPool::Find(std::string_view value) const {
+	if (index_.empty()) {
+		return {};
+	}
+	return index_[FindSlot(value)];
+}
+
+size_t StringPool::GetSize() const {
+	return size_;
+}
+
+size_t StringPool::GetCapacity() const {
+	return capacity_;
+}
+
+// место под строку в текущем блоке или в новом, если текущий заполнен
+char* StringPool::Allocate(size_t size) {
+	if (size > BLOCK_SIZE / 4) {
+		// длинная строка не занимает место в общем блоке
+		blocks_.push_back(std::make_unique<char[]>(size));
+		capacity_ += size;
+		return blocks_.back().get();
+	}
+	if (free_size_ < size || free_ == nullptr) {
+		blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+		capacity_ += BLOCK_SIZE;
+		free_ = blocks_.back().get();
+		free_size_ = BLOCK_SIZE;
+	}
+	char* data = free_;
+	free_ += size;
+	free_size_ -= size;
+	return data;
+}
+
+// ячейка со строкой value или свободная ячейка, в которую её следует поместить
+size_t StringPool::FindSlot(std::string_view value) const {
+	const size_t mask = index_.size() - 1;
+	size_t slot = std::hash<std::string_view>{}(value) & mask;
+	while (index_[slot].data() != nullptr && index_[slot] != value) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void StringPool::Rehash(size_t capacity) {
+	std::vector<std::string_view> index(capacity);
+	index.swap(index_);
+	for (std::string_view value : index) {
+		if (value.data() != nullptr) {
+			index_[FindSlot(value)] = value;
+		}
+	}
+}
\ No newline at end of file
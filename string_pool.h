@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+	// пул строк: каждая строка хранится один раз в непрерывных блоках памяти и не перемещается,
+	// поэтому string_view на строки пула действительны, пока жив пул.
+	// Индекс строк — таблица с открытой адресацией, без отдельного узла на каждую строку
+	class StringPool {
+	public:
+		StringPool() = default;
+		StringPool(const StringPool&) = delete;
+		StringPool& operator=(const StringPool&) = delete;
+
+		// строка пула, равная value; добавляется, если её ещё нет
+		std::string_view Intern(std::string_view value);
+		// строка пула, равная value (пустой string_view с data() == nullptr, если её нет)
+		std::string_view Find(std::string_view value) const;
+
+		// число различных строк
+		size_t GetSize() const;
+		// байт, занятых блоками
+		size_t GetCapacity() const;
+
+	private:
+		// размер блока; более длинные строки получают отдельный блок
+		static constexpr size_t BLOCK_SIZE = 1 << 16;
+		static constexpr size_t MIN_INDEX_CAPACITY = 16;
+
+		std::vector<std::unique_ptr<char[]>> blocks_;
+		char* free_ = nullptr;
+		size_t free_size_ = 0;
+		size_t capacity_ = 0;
+		// ячейки индекса (размер — степень двойки); свободная ячейка имеет data() == nullptr
+		std::vector<std::string_view> index_;
+		size_t size_ = 0;
+
+		char* Allocate(size_t size);
+		size_t FindSlot(std::string_view value) const;
+		void Rehash(size_t capacity);
+	};
+} // namespace transport_catalogue
\ No newline at end of file
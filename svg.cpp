@@ -175,4 +175,8 @@ namespace svg {
         out << "</svg> "sv;
     }
 
+    void Document::Clear() {
+        objects_.clear();
+    }
+
 }  // namespace svg
\ No newline at end of file
@@ -316,6 +316,9 @@ namespace svg {
 
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
+
+        // Удаляет все объекты документа
+        void Clear();
     };
 
     template <typename Obj>
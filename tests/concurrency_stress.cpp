@@ -0,0 +1,207 @@
+// Нагрузочная проверка потокобезопасности обработки запросов: 16 потоков одновременно
+// отвечают на перемешанные запросы Bus, Stop, Map, Route (между остановками и между точками)
+// и NearestStops к общим каталогу, карте и маршрутизатору. Ответы сравниваются с ответами
+// последовательной обработки; первый запрос Map тоже приходит из нескольких потоков сразу.
+//
+// Сборка с ThreadSanitizer и запуск из корня репозитория:
+//   g++ -std=c++17 -O1 -g -fsanitize=thread -pthread -I. tests/concurrency_stress.cpp $(find . -maxdepth 1 -name '*.cpp' ! -name main.cpp) -o concurrency_stress
+//   ./concurrency_stress [seed]
+// Код возврата 1 — ответ отличается от последовательного; гонки данных ThreadSanitizer сообщает сам.
+
+#include "json.h"
+#include "json_writer.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+constexpr size_t THREAD_COUNT = 16;
+constexpr size_t STOP_COUNT = 300;
+constexpr size_t BUS_COUNT = 100;
+constexpr size_t REQUEST_COUNT = 2000;
+
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue, std::mt19937& random) {
+    std::uniform_real_distribution<double> random_latitude(55.70, 55.80);
+    std::uniform_real_distribution<double> random_longitude(37.50, 37.65);
+    for (size_t stop = 0; stop < STOP_COUNT; ++stop) {
+        catalogue.AddStop("Stop "s + std::to_string(stop), {random_latitude(random), random_longitude(random)});
+    }
+
+    std::uniform_int_distribution<domain::StopId> random_stop(0, STOP_COUNT - 1);
+    std::uniform_int_distribution<size_t> random_length(3, 12);
+    std::uniform_int_distribution<int> random_distance(300, 4000);
+    for (size_t bus = 0; bus < BUS_COUNT; ++bus) {
+        const bool is_looped = bus % 3 == 0;
+        std::vector<domain::StopId> stops;
+        const size_t length = random_length(random);
+        for (size_t i = 0; i < length; ++i) {
+            stops.push_back(random_stop(random));
+        }
+        if (is_looped) {
+            stops.push_back(stops.front());
+        }
+        for (size_t i = 0; i + 1 < stops.size(); ++i) {
+            if (stops[i] != stops[i + 1]) {
+                catalogue.SetDistanceBetweenStops(stops[i], stops[i + 1], random_distance(random));
+            }
+        }
+        catalogue.AddBus(std::to_string(bus), std::move(stops),
+            is_looped ? domain::RouteType::IS_LOOPED : domain::RouteType::NOT_LOOPED);
+    }
+    catalogue.BuildBusesInfo();
+    catalogue.BuildStopIndex();
+}
+
+map_renderer::RenderSettings MakeRenderSettings() {
+    map_renderer::RenderSettings settings;
+    settings.width = 1200;
+    settings.height = 1200;
+    settings.padding = 50;
+    settings.line_width = 14;
+    settings.stop_radius = 5;
+    settings.bus_label_font_size = 20;
+    settings.bus_label_offset = {7, 15};
+    settings.stop_label_font_size = 20;
+    settings.stop_label_offset = {7, -3};
+    settings.underlayer_color = svg::Rgba{255, 255, 255, 0.85};
+    settings.underlayer_width = 3;
+    settings.color_palette = {svg::Color{"green"s}, svg::Rgb{255, 160, 0}, svg::Color{"red"s}};
+    return settings;
+}
+
+// запросы в виде JSON-массива; в запросах Bus, Stop и Route встречаются имена, которых нет в каталоге
+std::string MakeRequests(std::mt19937& random) {
+    std::uniform_int_distribution<size_t> random_stop(0, STOP_COUNT);
+    std::uniform_int_distribution<size_t> random_bus(0, BUS_COUNT);
+    std::uniform_int_distribution<int> random_type(0, 9);
+    std::uniform_real_distribution<double> random_latitude(55.70, 55.80);
+    std::uniform_real_distribution<double> random_longitude(37.50, 37.65);
+    // номер STOP_COUNT или BUS_COUNT — имя, которого нет в каталоге
+    auto stop_name = [&random, &random_stop]() {
+        return "\"Stop "s + std::to_string(random_stop(random)) + "\""s;
+    };
+    auto point = [&random, &random_latitude, &random_longitude]() {
+        return "{\"latitude\": "s + std::to_string(random_latitude(random))
+            + ", \"longitude\": "s + std::to_string(random_longitude(random)) + "}"s;
+    };
+
+    std::string requests = "["s;
+    for (size_t id = 0; id < REQUEST_COUNT; ++id) {
+        if (id != 0) {
+            requests += ", "sv;
+        }
+        requests += "{\"id\": "s + std::to_string(id) + ", "s;
+        const int type = random_type(random);
+        if (type == 0) {
+            requests += "\"type\": \"Bus\", \"name\": \""s + std::to_string(random_bus(random)) + "\"}"s;
+        }
+        else if (type == 1) {
+            requests += "\"type\": \"Stop\", \"name\": "s + stop_name() + "}"s;
+        }
+        else if (type == 2) {
+            requests += "\"type\": \"Map\"}"sv;
+        }
+        else if (type <= 5) {
+            requests += "\"type\": \"Route\", \"from\": "s + stop_name() + ", \"to\": "s + stop_name() + "}"s;
+        }
+        else if (type <= 7) {
+            requests += "\"type\": \"Route\", \"from\": "s + point() + ", \"to\": "s + point() + "}"s;
+        }
+        else {
+            const std::string center = point();
+            requests += "\"type\": \"NearestStops\", "s + center.substr(1, center.size() - 2);
+            requests += type == 8 ? ", \"count\": 5}"s : ", \"radius\": 1500}"s;
+        }
+    }
+    requests += "]"sv;
+    return requests;
+}
+
+std::string Answer(const request_handler::RequestHandler& handler, const json::Node& request, const svg::Document& map_svg) {
+    std::ostringstream output;
+    {
+        json::Writer writer(output, json::Writer::Format::COMPACT);
+        writer.StartArray();
+        handler.RequestProcess(request.AsMap(), map_svg, writer);
+        writer.EndArray();
+    }
+    return output.str();
+}
+
+// 0 — все ответы совпали с последовательными
+size_t RunStress(const transport_catalogue::TransportCatalogue& catalogue, const map_renderer::MapRender& renderer,
+                 const svg::Document& map_svg, const json::Array& requests, graph::RouterMode mode) {
+    transport_router::RouterSettings settings;
+    settings.bus_wait_time = 3;
+    settings.bus_velocity = 35;
+    settings.router_mode = mode;
+
+    std::vector<std::string> expected;
+    {
+        const request_handler::RequestHandler handler(catalogue, renderer, settings);
+        for (const json::Node& request : requests) {
+            expected.push_back(Answer(handler, request, map_svg));
+        }
+    }
+
+    // новый обработчик: карта ещё не выведена в SVG, первые запросы Map приходят одновременно
+    const request_handler::RequestHandler handler(catalogue, renderer, settings);
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < THREAD_COUNT; ++thread) {
+        threads.emplace_back([thread, &handler, &requests, &map_svg, &expected, &mismatches]() {
+            // каждый поток проходит все запросы, начиная со своего места
+            for (size_t i = 0; i < requests.size(); ++i) {
+                const size_t index = (i + thread * requests.size() / THREAD_COUNT) % requests.size();
+                if (Answer(handler, requests[index], map_svg) != expected[index]) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return mismatches;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    std::mt19937 random(seed);
+
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue, random);
+    map_renderer::MapRender renderer;
+    svg::Document map_svg;
+    renderer.SetBuses(catalogue).SetRenderSettings(MakeRenderSettings()).MapRendering(map_svg);
+
+    std::istringstream input(MakeRequests(random));
+    const json::Document document = json::Load(input);
+    const json::Array& requests = document.GetRoot().AsArray();
+
+    size_t mismatches = 0;
+    for (const auto& [mode, mode_name] : {std::pair{graph::RouterMode::PRECOMPUTED, "precomputed"sv},
+                                          std::pair{graph::RouterMode::ON_DEMAND, "on_demand"sv},
+                                          std::pair{graph::RouterMode::CONTRACTION_HIERARCHY, "contraction_hierarchy"sv}}) {
+        const size_t mode_mismatches = RunStress(catalogue, renderer, map_svg, requests, mode);
+        std::cout << mode_name << ": "sv << THREAD_COUNT << " threads x "sv << requests.size()
+                  << " requests, mismatches "sv << mode_mismatches << '\n';
+        mismatches += mode_mismatches;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+// Сравнение маршрутов, найденных разными режимами маршрутизатора на одной базе.
+// Режимы обязаны находить маршруты одного веса; при равных по времени путях
+// последовательность рёбер может различаться — такие расхождения только подсчитываются.
+//
+// Сборка и запуск из корня репозитория:
+//   g++ -std=c++17 -O2 -pthread -I. tests/router_modes.cpp $(find . -maxdepth 1 -name '*.cpp' ! -name main.cpp) -o router_modes
+//   ./router_modes [seed]
+// Код возврата 1 — найден маршрут другого веса или маршрут есть не во всех режимах.
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// решётка остановок с одинаковыми расстояниями даёт много равных по времени путей,
+// случайные маршруты поверх неё — пересадки и разные расстояния
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue, unsigned seed) {
+    constexpr size_t GRID_SIZE = 8;
+    constexpr size_t RANDOM_BUS_COUNT = 12;
+    std::mt19937 random(seed);
+
+    for (size_t row = 0; row < GRID_SIZE; ++row) {
+        for (size_t column = 0; column < GRID_SIZE; ++column) {
+            const std::string name = "Stop "s + std::to_string(row) + "-"s + std::to_string(column);
+            catalogue.AddStop(name, {55.6 + 0.01 * row, 37.5 + 0.01 * column});
+        }
+    }
+    auto stop_id = [](size_t row, size_t column) {
+        return static_cast<domain::StopId>(row * GRID_SIZE + column);
+    };
+    for (size_t row = 0; row < GRID_SIZE; ++row) {
+        for (size_t column = 0; column < GRID_SIZE; ++column) {
+            if (column + 1 < GRID_SIZE) {
+                catalogue.SetDistanceBetweenStops(stop_id(row, column), stop_id(row, column + 1), 1000);
+            }
+            if (row + 1 < GRID_SIZE) {
+                catalogue.SetDistanceBetweenStops(stop_id(row, column), stop_id(row + 1, column), 1000);
+            }
+        }
+    }
+
+    for (size_t line = 0; line < GRID_SIZE; ++line) {
+        std::vector<domain::StopId> row_stops;
+        std::vector<domain::StopId> column_stops;
+        for (size_t position = 0; position < GRID_SIZE; ++position) {
+            row_stops.push_back(stop_id(line, position));
+            column_stops.push_back(stop_id(position, line));
+        }
+        catalogue.AddBus("R"s + std::to_string(line), std::move(row_stops), domain::RouteType::NOT_LOOPED);
+        catalogue.AddBus("C"s + std::to_string(line), std::move(column_stops), domain::RouteType::NOT_LOOPED);
+    }
+
+    std::uniform_int_distribution<domain::StopId> random_stop(0, GRID_SIZE * GRID_SIZE - 1);
+    std::uniform_int_distribution<int> random_distance(500, 5000);
+    for (size_t bus = 0; bus < RANDOM_BUS_COUNT; ++bus) {
+        const bool is_looped = bus % 2 == 0;
+        std::vector<domain::StopId> stops;
+        for (size_t i = 0; i < 4 + bus % 3; ++i) {
+            stops.push_back(random_stop(random));
+        }
+        if (is_looped) {
+            stops.push_back(stops.front());
+        }
+        for (size_t i = 0; i + 1 < stops.size(); ++i) {
+            if (stops[i] != stops[i + 1]) {
+                catalogue.SetDistanceBetweenStops(stops[i], stops[i + 1], random_distance(random));
+            }
+        }
+        catalogue.AddBus("X"s + std::to_string(bus), std::move(stops),
+            is_looped ? domain::RouteType::IS_LOOPED : domain::RouteType::NOT_LOOPED);
+    }
+    catalogue.BuildBusesInfo();
+    catalogue.BuildStopIndex();
+}
+
+double ComputeTotalTime(const std::vector<transport_router::RouterEdge>& edges) {
+    double total_time = 0;
+    for (const transport_router::RouterEdge& edge : edges) {
+        total_time += edge.total_time;
+    }
+    return total_time;
+}
+
+bool IsSameEdges(const std::vector<transport_router::RouterEdge>& lhs, const std::vector<transport_router::RouterEdge>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].bus_name != rhs[i].bus_name || lhs[i].stop_name_from != rhs[i].stop_name_from
+            || lhs[i].stop_name_to != rhs[i].stop_name_to || lhs[i].stop_count != rhs[i].stop_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Comparison {
+    size_t routes = 0;
+    size_t ties = 0;    // тот же вес, другие рёбра
+    size_t errors = 0;  // другой вес или маршрут найден не во всех режимах
+};
+
+Comparison CompareModes(const transport_catalogue::TransportCatalogue& catalogue, transport_router::GraphModel model) {
+    transport_router::RouterSettings settings;
+    settings.bus_wait_time = 2;
+    settings.bus_velocity = 30;
+    settings.graph_model = model;
+
+    // эталон — таблица всех кратчайших путей
+    settings.router_mode = graph::RouterMode::PRECOMPUTED;
+    const transport_router::TransportRouter reference(catalogue, settings);
+    settings.router_mode = graph::RouterMode::ON_DEMAND;
+    const transport_router::TransportRouter on_demand(catalogue, settings);
+    settings.router_mode = graph::RouterMode::CONTRACTION_HIERARCHY;
+    const transport_router::TransportRouter hierarchy(catalogue, settings);
+
+    Comparison comparison;
+    const std::deque<const domain::Stop*> stops = catalogue.GetStops();
+    for (const domain::Stop* from : stops) {
+        for (const domain::Stop* to : stops) {
+            const auto expected = reference.BuildRoute(from->name_, to->name_);
+            for (const transport_router::TransportRouter* router : {&on_demand, &hierarchy}) {
+                const auto route = router->BuildRoute(from->name_, to->name_);
+                ++comparison.routes;
+                if (expected.has_value() != route.has_value()) {
+                    ++comparison.errors;
+                    continue;
+                }
+                if (!expected || IsSameEdges(*expected, *route)) {
+                    continue;
+                }
+                const double expected_time = ComputeTotalTime(*expected);
+                if (std::abs(expected_time - ComputeTotalTime(*route)) > 1e-9 * std::max(1., expected_time)) {
+                    ++comparison.errors;
+                    std::cerr << from->name_ << " -> "sv << to->name_ << ": total_time differs\n"sv;
+                }
+                else {
+                    ++comparison.ties;
+                }
+            }
+        }
+    }
+    return comparison;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const unsigned seed = argc > 1 ? static_cast<unsigned>(std::strtoul(argv[1], nullptr, 10)) : 1;
+    transport_catalogue::TransportCatalogue catalogue;
+    FillCatalogue(catalogue, seed);
+
+    size_t errors = 0;
+    for (const auto& [model, model_name] : {std::pair{transport_router::GraphModel::STOP_PAIRS, "stop_pairs"sv},
+                                            std::pair{transport_router::GraphModel::BOARDING, "boarding"sv}}) {
+        const Comparison comparison = CompareModes(catalogue, model);
+        std::cout << model_name << ": routes "sv << comparison.routes << ", equal-weight ties with other edges "sv
+                  << comparison.ties << ", errors "sv << comparison.errors << '\n';
+        errors += comparison.errors;
+    }
+    return errors == 0 ? 0 : 1;
+}
\ No newline at end of file
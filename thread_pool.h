@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace thread_pool {
+    // пул потоков фиксированного размера с общей очередью задач;
+    // результат задачи (или её исключение) передаётся через std::future
+    class ThreadPool {
+    public:
+        // thread_count == 0 — по числу аппаратных потоков
+        explicit ThreadPool(size_t thread_count);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        // дожидается выполнения всех поставленных задач
+        ~ThreadPool();
+
+        size_t GetThreadCount() const;
+
+        template <typename Task>
+        std::future<std::invoke_result_t<Task>> Submit(Task task);
+
+    private:
+        std::vector<std::thread> threads_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable has_tasks_;
+        bool stopping_ = false;
+
+        void Work();
+    };
+
+    // вызов function(begin, end) для частей диапазона [0, count) в потоках пула и ожидание их завершения;
+    // без пула или с одним потоком — один вызов function(0, count) в текущем потоке.
+    // Границы частей зависят только от count и числа потоков; первое исключение из частей пробрасывается.
+    // Нельзя вызывать из задачи того же пула: поток ждал бы части, стоящие в очереди за ним
+    template <typename Function>
+    void ParallelFor(ThreadPool* pool, size_t count, Function function);
+
+    template <typename Task>
+    std::future<std::invoke_result_t<Task>> ThreadPool::Submit(Task task) {
+        // packaged_task не копируется, а std::function требует копируемого объекта
+        auto packaged_task = std::make_shared<std::packaged_task<std::invoke_result_t<Task>()>>(std::move(task));
+        std::future<std::invoke_result_t<Task>> result = packaged_task->get_future();
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.emplace_back([packaged_task] {
+                (*packaged_task)();
+            });
+        }
+        has_tasks_.notify_one();
+        return result;
+    }
+
+    template <typename Function>
+    void ParallelFor(ThreadPool* pool, size_t count, Function function) {
+        if (pool == nullptr || pool->GetThreadCount() < 2 || count < 2) {
+            function(size_t{0}, count);
+            return;
+        }
+        // несколько частей на поток, чтобы неравные по времени части не оставляли потоки без работы
+        const size_t chunk_count = std::min(count, pool->GetThreadCount() * 4);
+        const size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+        std::vector<std::future<void>> chunks;
+        chunks.reserve(chunk_count);
+        for (size_t begin = 0; begin < count; begin += chunk_size) {
+            const size_t end = std::min(begin + chunk_size, count);
+            chunks.push_back(pool->Submit([&function, begin, end] {
+                function(begin, end);
+            }));
+        }
+        // function используется частями по ссылке, поэтому при ошибке сначала дожидаемся всех частей
+        std::exception_ptr error;
+        for (std::future<void>& chunk : chunks) {
+            try {
+                chunk.get();
+            }
+            catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+} // namespace thread_pool
\ No newline at end of file
@@ -1,58 +1,153 @@
 #include "transport_catalogue.h"
 
 #include <algorithm>
+#include <iterator>
+#include <stdexcept>
 
 using namespace transport_catalogue;
 
 // добавление остановки
-void TransportCatalogue::AddStop(std::string name, Coordinates point) {
-	stops_.emplace_back(name, point);
+StopId TransportCatalogue::AddStop(std::string_view name, Coordinates point) {
+	const StopId id = static_cast<StopId>(stops_.size());
+	stops_.emplace_back(id, names_.Intern(name), point);
+	stop_coordinates_.Add(point);
+	stop_points_.Add(point);
+	is_stop_removed_.push_back(false);
+	stopname_to_stop_[stops_.back().name_] = &stops_.back();
 	buses_to_stops_[stops_.back().name_];
-}
-
-size_t TransportCatalogue::StopsHasher::operator()(const std::pair<const Stop*, const Stop*>& two_stops) const {
-	size_t h_1 = hasher_(two_stops.first);
-	size_t h_2 = hasher_(two_stops.second);
-	return h_2 * 42 + h_1 * (42 * 42);
+	if (is_tracking_changes_) {
+		changes_.stops_changed = true;
+	}
+	return id;
 }
 
 // добавление маршрутая
-void TransportCatalogue::AddBus(std::string name, std::vector<const Stop*> stops_of_bus, RouteType loop) {
-	buses_.emplace_back(name, stops_of_bus, loop);
-	const Bus* from_buses_ = &FindBus(name);
-	for (const Stop* stop : from_buses_->stops_of_bus_) {
-		buses_to_stops_[stop->name_].insert(from_buses_->name_);
+BusId TransportCatalogue::AddBus(std::string_view name, std::vector<StopId> stops_of_bus, RouteType loop) {
+	const BusId id = static_cast<BusId>(buses_.size());
+	buses_.emplace_back(id, names_.Intern(name), std::move(stops_of_bus), loop);
+	is_bus_removed_.push_back(false);
+	const Bus* from_buses_ = &buses_.back();
+	busname_to_bus_[from_buses_->name_] = from_buses_;
+	for (StopId stop : from_buses_->stops_of_bus_) {
+		buses_to_stops_[stops_[stop].name_].insert(from_buses_->name_);
+	}
+	if (is_tracking_changes_) {
+		changes_.rerouted_buses.push_back(id);
 	}
+	return id;
+}
+
+// доступ к остановке и маршруту по идентификатору
+const Stop& TransportCatalogue::GetStop(StopId id) const {
+	return stops_[id];
+}
+const Bus& TransportCatalogue::GetBus(BusId id) const {
+	return buses_[id];
+}
+size_t TransportCatalogue::GetStopCount() const {
+	return stops_.size();
+}
+size_t TransportCatalogue::GetBusCount() const {
+	return buses_.size();
+}
+bool TransportCatalogue::IsStopRemoved(StopId id) const {
+	return is_stop_removed_[id];
+}
+bool TransportCatalogue::IsBusRemoved(BusId id) const {
+	return is_bus_removed_[id];
 }
 
 // поиск остановки по имени
-const Stop& TransportCatalogue::FindStop(const std::string& name) {
-	for (const Stop& stop : stops_) {
-		if (stop.name_ == name) {
-			return stop;
-		}
-	}
-	static Stop stop; // стандартное имя остановки
-	return stop;
+const Stop* TransportCatalogue::FindStop(std::string_view name) const {
+	auto it = stopname_to_stop_.find(name);
+	return it == stopname_to_stop_.end() ? nullptr : it->second;
 }
 
 // поиск маршрута по номеру
-const Bus& TransportCatalogue::FindBus(const std::string& name) {
+const Bus* TransportCatalogue::FindBus(std::string_view name) const {
+	auto it = busname_to_bus_.find(name);
+	return it == busname_to_bus_.end() ? nullptr : it->second;
+}
+
+// поиск информации о маршруте по номеру
+const BusInfo* TransportCatalogue::GetBusInfo(std::string_view name) const {
+	auto it = busname_to_info_.find(name);
+	return it == busname_to_info_.end() ? nullptr : &it->second;
+}
+
+// подсчет информации обо всех маршрутах
+void TransportCatalogue::BuildBusesInfo(thread_pool::ThreadPool* pool) {
+	std::vector<const Bus*> buses;
+	buses.reserve(buses_.size());
 	for (const Bus& bus : buses_) {
-		if (bus.name_ == name) {
-			return bus;
+		if (!is_bus_removed_[bus.id_]) {
+			buses.push_back(&bus);
 		}
 	}
-	static Bus bus; // стандартный номер маршрута
-	return bus;
+	const std::vector<BusInfo> buses_info = ComputeBusesInfo(buses, pool);
+	busname_to_info_.clear();
+	busname_to_info_.reserve(buses.size());
+	for (size_t i = 0; i < buses.size(); ++i) {
+		busname_to_info_[buses[i]->name_] = buses_info[i];
+	}
+	is_tracking_changes_ = true;
+	changes_ = CatalogueChanges{};
 }
 
-// поиск информации о маршруте по номеру
-BusInfo TransportCatalogue::GetBusInfo(const std::string& name) {
+std::vector<BusInfo> TransportCatalogue::ComputeBusesInfo(const std::vector<const Bus*>& buses, thread_pool::ThreadPool* pool) const {
+	// перегоны маршрута i занимают участок [offsets[i], offsets[i + 1]) общих массивов
+	std::vector<size_t> offsets(buses.size() + 1, 0);
+	for (size_t i = 0; i < buses.size(); ++i) {
+		offsets[i + 1] = offsets[i] + GetBusSegmentCount(*buses[i]);
+	}
+	std::vector<StopId> segments_from(offsets.back());
+	std::vector<StopId> segments_to(offsets.back());
+	for (size_t i = 0; i < buses.size(); ++i) {
+		AddBusSegments(*buses[i], segments_from.data() + offsets[i], segments_to.data() + offsets[i]);
+	}
+	std::vector<double> segment_lengths(offsets.back());
+	thread_pool::ParallelFor(pool, segment_lengths.size(), [this, &segments_from, &segments_to, &segment_lengths](size_t begin, size_t end) {
+		stop_points_.ComputeDistances(segments_from.data() + begin, segments_to.data() + begin, end - begin, segment_lengths.data() + begin);
+	});
+
+	// информация считается независимо для каждого маршрута
+	std::vector<BusInfo> buses_info(buses.size());
+	thread_pool::ParallelFor(pool, buses.size(), [this, &buses, &offsets, &segment_lengths, &buses_info](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			buses_info[i] = ComputeBusInfo(*buses[i], segment_lengths.data() + offsets[i]);
+		}
+	});
+	return buses_info;
+}
+
+// построение пространственного индекса остановок (удалённые остановки в него не входят)
+void TransportCatalogue::BuildStopIndex() {
+	if (std::find(is_stop_removed_.begin(), is_stop_removed_.end(), true) == is_stop_removed_.end()) {
+		stop_index_ = StopIndex(stop_coordinates_);
+		return;
+	}
+	std::vector<StopId> stops;
+	stops.reserve(stops_.size());
+	for (StopId id = 0; id < stops_.size(); ++id) {
+		if (!is_stop_removed_[id]) {
+			stops.push_back(id);
+		}
+	}
+	stop_index_ = StopIndex(stop_coordinates_, stops);
+}
+
+const StopIndex& TransportCatalogue::GetStopIndex() const {
+	return stop_index_;
+}
+
+// подсчет информации о маршруте
+BusInfo TransportCatalogue::ComputeBusInfo(const Bus& bus, const double* segment_lengths) const {
+	// у маршрута без остановок нет ни перегонов, ни длины
+	if (bus.stops_of_bus_.empty()) {
+		return BusInfo{ 0, 0, 0, 0., 0. };
+	}
 	// хранилище информации о маршруте
 	BusInfo info;
-	// находим общую информацию о маршруте (номер, остановки, тип[прямой/кольцевой])
-	Bus bus = FindBus(name);
 	// подсчет количества уникальных остановок
 	info.unique_stops_num_ = GetBusInfoUniqueStops(bus.stops_of_bus_);
 	// введем коэффициент для работы с маршрутом
@@ -60,18 +155,18 @@ BusInfo TransportCatalogue::GetBusInfo(const std::string& name) {
 	// подсчет кол-ва остановок
 	info.stops_num_ = GetBusLoopStopNum(bus);
 	// подсчет длины маршурута 
-	std::pair<double, double> direct_distance_real_distance = GetBusInfoLoopDistance(bus, looped_coeff);
+	const double distance = GetBusInfoGeoDistance(bus, segment_lengths);
 	// заполняем прямую длину маршрута
-	info.distance_length_ = direct_distance_real_distance.first;
+	info.distance_length_ = distance;
 	// заполняем фактическую длину маршрута
-	info.real_distance_length_ = direct_distance_real_distance.second;
+	info.real_distance_length_ = GetBusInfoRealDistance(bus, looped_coeff);
 	// заполняем коэффициент извилистости
-	info.curvature_ = direct_distance_real_distance.second / direct_distance_real_distance.first;
+	info.curvature_ = info.real_distance_length_ / distance;
 	return info;
 }
 
 // подсчет коэффициента для работы с маршрутом
-double TransportCatalogue::GetBusLoopCoeff(Bus& bus) {
+double TransportCatalogue::GetBusLoopCoeff(const Bus& bus) const {
 	double looped_coeff;
 	if (bus.loop_ == transport_catalogue::RouteType::IS_LOOPED) {
 		looped_coeff = GetDistanceBetweenStops(bus.stops_of_bus_[bus.stops_of_bus_.size() - 1], bus.stops_of_bus_[0]);
@@ -83,7 +178,7 @@ double TransportCatalogue::GetBusLoopCoeff(Bus& bus) {
 }
 
 // подсчет кол-ва остановок
-size_t TransportCatalogue::GetBusLoopStopNum(Bus& bus) {
+size_t TransportCatalogue::GetBusLoopStopNum(const Bus& bus) const {
 	size_t stops_num;
 	if (bus.loop_ == transport_catalogue::RouteType::IS_LOOPED) {
 		stops_num = bus.stops_of_bus_.size();
@@ -94,45 +189,54 @@ size_t TransportCatalogue::GetBusLoopStopNum(Bus& bus) {
 	return stops_num;
 }
 
-// подсчет длины маршурута 
-std::pair<double, double> TransportCatalogue::GetBusInfoLoopDistance(Bus& bus, double& looped_coeff) {
-	// хранилище длины маршрута
+// количество перегонов маршрута в прямом направлении
+size_t TransportCatalogue::GetBusSegmentCount(const Bus& bus) const {
+	const size_t stops_count = bus.stops_of_bus_.size();
+	if (stops_count < 2) {
+		return 0;
+	}
+	return bus.loop_ == transport_catalogue::RouteType::IS_LOOPED ? stops_count : stops_count - 1;
+}
+
+// заполнение перегонов маршрута: соседние остановки и, для кольцевого, от последней до первой
+void TransportCatalogue::AddBusSegments(const Bus& bus, StopId* from, StopId* to) const {
+	const size_t segment_count = GetBusSegmentCount(bus);
+	for (size_t i = 0; i < segment_count; ++i) {
+		from[i] = bus.stops_of_bus_[i];
+		to[i] = bus.stops_of_bus_[(i + 1) % bus.stops_of_bus_.size()];
+	}
+}
+
+// подсчет длины маршрута по координатам
+double TransportCatalogue::GetBusInfoGeoDistance(const Bus& bus, const double* segment_lengths) const {
 	double distance = 0;
-	// хранилище фактической длины маршрута
+	const size_t segment_count = GetBusSegmentCount(bus);
+	for (size_t i = 0; i < segment_count; ++i) {
+		distance += segment_lengths[i];
+	}
+	if (bus.loop_ == transport_catalogue::RouteType::NOT_LOOPED) {
+		distance *= 2.;
+	}
+	return distance;
+}
+
+// подсчет фактической длины маршрута
+double TransportCatalogue::GetBusInfoRealDistance(const Bus& bus, double looped_coeff) const {
 	double real_distance = 0;
-	// stop_it - итератор на остановку, i - порядковый номер остановки 
-	for (auto [stop_it, i] = std::tuple(bus.stops_of_bus_.begin(), 0); ; ++i) {
-		if (i == int(bus.stops_of_bus_.size() - 1)) {
-			real_distance += looped_coeff;
-			break;
-		}
+	for (size_t i = 0; i + 1 < bus.stops_of_bus_.size(); ++i) {
 		real_distance += GetDistanceBetweenStops(bus.stops_of_bus_[i], bus.stops_of_bus_[i + 1]);
-		Stop from = **stop_it;
-		++stop_it;
-		if (stop_it == bus.stops_of_bus_.end()) {
-			break;
-		}
-		Stop to = **stop_it;
-		distance += ComputeDistance(from.coordinates_, to.coordinates_);
-		if (bus.loop_ == transport_catalogue::RouteType::IS_LOOPED) {
-			// заполняем кольцо маршрута
-			if (stop_it == bus.stops_of_bus_.end() - 1) {
-				Stop loop_end = **bus.stops_of_bus_.begin();
-				distance += ComputeDistance(to.coordinates_, loop_end.coordinates_);
-			}
-		}
 	}
+	real_distance += looped_coeff;
 	if (bus.loop_ == transport_catalogue::RouteType::NOT_LOOPED) {
-		distance *= 2.;
 		for (size_t i = bus.stops_of_bus_.size() - 1; i != 0; --i) {
 			real_distance += GetDistanceBetweenStops(bus.stops_of_bus_[i], bus.stops_of_bus_[i - 1]);
 		}
 	}
-	return { distance, real_distance };
+	return real_distance;
 }
 
 // подсчет количества уникальных остановок
-size_t TransportCatalogue::GetBusInfoUniqueStops(std::vector<const Stop*> stops_of_bus) {
+size_t TransportCatalogue::GetBusInfoUniqueStops(std::vector<StopId> stops_of_bus) const {
 	size_t unique_stops;
 	std::sort(stops_of_bus.begin(), stops_of_bus.end());
 	stops_of_bus.erase(unique(stops_of_bus.begin(), stops_of_bus.end()), stops_of_bus.end());
@@ -141,34 +245,32 @@ size_t TransportCatalogue::GetBusInfoUniqueStops(std::vector<const Stop*> stops_
 }
 
 // получение всех маршрутов с их остановками
-std::unordered_map<std::string_view, std::set<std::string_view>>& TransportCatalogue::GetBusesToStops() {
+const std::unordered_map<std::string_view, std::set<std::string_view>>& TransportCatalogue::GetBusesToStops() const {
 	return buses_to_stops_;
 }
 
 // получение информации о дистанции между остановками
-double TransportCatalogue::GetDistanceBetweenStops(const std::string& stop_name, const std::string& next_stop_name) {
-	return GetDistanceBetweenStops(&FindStop(stop_name), &FindStop(next_stop_name));
+double TransportCatalogue::GetDistanceBetweenStops(std::string_view stop_name, std::string_view next_stop_name) const {
+	const Stop* stop = FindStop(stop_name);
+	const Stop* next_stop = FindStop(next_stop_name);
+	return stop == nullptr || next_stop == nullptr ? 0 : GetDistanceBetweenStops(stop->id_, next_stop->id_);
 }
-double TransportCatalogue::GetDistanceBetweenStops(const Stop* stop, const Stop* next_stop) const {
-	auto stops = std::make_pair(stop, next_stop);
-	double result = 0;
-	if (stop_pair_to_distance_.count(stops)) {
-		result = stop_pair_to_distance_.at(stops);
-	}
-	else {
-		try {
-			result = stop_pair_to_distance_.at(std::make_pair(next_stop, stop));
-		}
-		catch (...) {}
-	}
-	return result;
+double TransportCatalogue::GetDistanceBetweenStops(StopId stop, StopId next_stop) const {
+	return road_distances_.Get(stop, next_stop);
+}
+
+// получение всех заданных дистанций между остановками
+const RoadDistances& TransportCatalogue::GetDistances() const {
+	return road_distances_;
 }
 
 // получение доступа к маршрутам
 const std::deque<const Bus*> TransportCatalogue::GetBuses() const {
 	std::deque<const Bus*> buses;
 	for (const auto& bus : buses_) {
-		buses.push_back(&bus);
+		if (!is_bus_removed_[bus.id_]) {
+			buses.push_back(&bus);
+		}
 	}
 
 	std::sort(buses.begin(), buses.end(),
@@ -182,25 +284,152 @@ const std::deque<const Bus*> TransportCatalogue::GetBuses() const {
 const std::deque<const Stop*> TransportCatalogue::GetStops() const {
 	std::deque<const Stop*> stops;
 	for (const auto& stop : stops_) {
-		stops.push_back(&stop);
+		if (!is_stop_removed_[stop.id_]) {
+			stops.push_back(&stop);
+		}
 	}
 	return stops;
 }
 
-// получение координат каждой остановки из маршрутов
-const std::vector<Coordinates> TransportCatalogue::GetAllStopsCoordinates() const {
-	std::vector<Coordinates> stops_coordinates;
-	for (const auto& bus : buses_) {
-		for (const auto& stop : bus.stops_of_bus_) {
-			stops_coordinates.push_back(stop->coordinates_);
+// координаты остановок раздельными массивами
+const geo::CoordinateArrays& TransportCatalogue::GetStopCoordinates() const {
+	return stop_coordinates_;
+}
+
+// заполнение информации о дистанции между остановками
+void TransportCatalogue::SetDistanceBetweenStops(std::string_view stop_name, std::string_view next_stop_name, double distance) {
+	const Stop* stop = FindStop(stop_name);
+	const Stop* next_stop = FindStop(next_stop_name);
+	if (stop != nullptr && next_stop != nullptr) {
+		SetDistanceBetweenStops(stop->id_, next_stop->id_, distance);
+	}
+}
+void TransportCatalogue::SetDistanceBetweenStops(StopId stop, StopId next_stop, double distance) {
+	road_distances_.Set(stop, next_stop, distance);
+	if (is_tracking_changes_) {
+		AddStopBusesToChanges(stop, next_stop, changes_.remeasured_buses);
+	}
+}
+
+// перемещение остановки: меняются длины по координатам маршрутов через неё
+void TransportCatalogue::MoveStop(StopId id, Coordinates point) {
+	Stop& stop = stops_[id];
+	if (stop.coordinates_ == point) {
+		return;
+	}
+	stop.coordinates_ = point;
+	stop_coordinates_.Set(id, point);
+	stop_points_.Set(id, point);
+	if (is_tracking_changes_) {
+		changes_.stops_changed = true;
+		AddStopBusesToChanges(id, std::nullopt, changes_.moved_buses);
+	}
+}
+
+// удаление остановки: её идентификатор остаётся занятым, а имя перестаёт находиться
+void TransportCatalogue::RemoveStop(StopId id) {
+	const Stop& stop = stops_[id];
+	if (const auto it = buses_to_stops_.find(stop.name_); it != buses_to_stops_.end() && !it->second.empty()) {
+		throw std::invalid_argument("Stop "s + std::string(stop.name_) + " is used by bus "s + std::string(*it->second.begin()));
+	}
+	stopname_to_stop_.erase(stop.name_);
+	buses_to_stops_.erase(stop.name_);
+	is_stop_removed_[id] = true;
+	if (is_tracking_changes_) {
+		changes_.stops_changed = true;
+	}
+}
+
+// замена остановок маршрута
+void TransportCatalogue::SetBusStops(BusId id, std::vector<StopId> stops_of_bus, RouteType loop) {
+	Bus& bus = buses_[id];
+	for (StopId stop : bus.stops_of_bus_) {
+		buses_to_stops_[stops_[stop].name_].erase(bus.name_);
+	}
+	bus.stops_of_bus_ = std::move(stops_of_bus);
+	bus.loop_ = loop;
+	for (StopId stop : bus.stops_of_bus_) {
+		buses_to_stops_[stops_[stop].name_].insert(bus.name_);
+	}
+	if (is_tracking_changes_) {
+		changes_.rerouted_buses.push_back(id);
+	}
+}
+
+// удаление маршрута: его идентификатор остаётся занятым, а номер перестаёт находиться
+void TransportCatalogue::RemoveBus(BusId id) {
+	const Bus& bus = buses_[id];
+	for (StopId stop : bus.stops_of_bus_) {
+		buses_to_stops_[stops_[stop].name_].erase(bus.name_);
+	}
+	busname_to_bus_.erase(bus.name_);
+	busname_to_info_.erase(bus.name_);
+	is_bus_removed_[id] = true;
+	if (is_tracking_changes_) {
+		changes_.rerouted_buses.push_back(id);
+	}
+}
+
+void TransportCatalogue::RemoveDistanceBetweenStops(StopId stop, StopId next_stop) {
+	if (road_distances_.Erase(stop, next_stop) && is_tracking_changes_) {
+		AddStopBusesToChanges(stop, next_stop, changes_.remeasured_buses);
+	}
+}
+
+// маршруты через остановку stop, а если задана next_stop — через обе
+void TransportCatalogue::AddStopBusesToChanges(StopId stop, std::optional<StopId> next_stop, std::vector<BusId>& buses) {
+	const auto it = buses_to_stops_.find(stops_[stop].name_);
+	if (it == buses_to_stops_.end()) {
+		return;
+	}
+	for (std::string_view bus_name : it->second) {
+		const Bus* bus = FindBus(bus_name);
+		if (!next_stop || std::find(bus->stops_of_bus_.begin(), bus->stops_of_bus_.end(), *next_stop) != bus->stops_of_bus_.end()) {
+			buses.push_back(bus->id_);
 		}
 	}
-	return stops_coordinates;
 }
 
-// заполнение информации о дистанции между остановками
-void TransportCatalogue::SetDistanceBetweenStops(std::string stop_name, std::string next_stop_name, double distance) {
-	const Stop* stop = &FindStop(stop_name);
-	const Stop* next_stop = &FindStop(next_stop_name);
-	stop_pair_to_distance_[std::make_pair(stop, next_stop)] = distance;
+// пересчёт производных данных только для затронутых маршрутов
+CatalogueChanges TransportCatalogue::ApplyChanges(thread_pool::ThreadPool* pool) {
+	CatalogueChanges changes = std::move(changes_);
+	changes_ = CatalogueChanges{};
+	auto normalize = [](std::vector<BusId>& buses, const std::vector<BusId>& excluded) {
+		std::sort(buses.begin(), buses.end());
+		buses.erase(std::unique(buses.begin(), buses.end()), buses.end());
+		std::vector<BusId> result;
+		std::set_difference(buses.begin(), buses.end(), excluded.begin(), excluded.end(), std::back_inserter(result));
+		buses = std::move(result);
+	};
+	normalize(changes.rerouted_buses, {});
+	normalize(changes.remeasured_buses, changes.rerouted_buses);
+	normalize(changes.moved_buses, changes.rerouted_buses);
+
+	// информация пересчитывается по одному разу для каждого затронутого маршрута
+	std::vector<BusId> changed_buses;
+	std::set_union(changes.remeasured_buses.begin(), changes.remeasured_buses.end(),
+		changes.moved_buses.begin(), changes.moved_buses.end(), std::back_inserter(changed_buses));
+	changed_buses.insert(changed_buses.end(), changes.rerouted_buses.begin(), changes.rerouted_buses.end());
+	std::vector<const Bus*> buses;
+	for (BusId id : changed_buses) {
+		if (!is_bus_removed_[id]) {
+			buses.push_back(&buses_[id]);
+		}
+	}
+	const std::vector<BusInfo> buses_info = ComputeBusesInfo(buses, pool);
+	for (size_t i = 0; i < buses.size(); ++i) {
+		busname_to_info_[buses[i]->name_] = buses_info[i];
+	}
+	if (changes.stops_changed) {
+		BuildStopIndex();
+	}
+	return changes;
+}
+
+bool CatalogueChanges::IsEmpty() const {
+	return rerouted_buses.empty() && remeasured_buses.empty() && moved_buses.empty() && !stops_changed;
+}
+
+bool CatalogueChanges::HasMapChanges() const {
+	return !rerouted_buses.empty() || !moved_buses.empty();
 }
\ No newline at end of file
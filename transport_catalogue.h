@@ -1,73 +1,165 @@
 #pragma once
 
 #include "domain.h"
+#include "road_distances.h"
+#include "stop_index.h"
+#include "string_pool.h"
+#include "thread_pool.h"
 
 #include <set>
 #include <deque>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 
 namespace transport_catalogue {
 	using namespace domain;
 
-	// класс каталога маршрутов
+	// изменения каталога, сделанные после BuildBusesInfo и ещё не учтённые в производных данных.
+	// Списки маршрутов упорядочены; изменённые маршруты не повторяются в двух других списках
+	struct CatalogueChanges {
+		// маршруты с изменённым составом остановок: добавленные, удалённые и изменённые
+		std::vector<BusId> rerouted_buses;
+		// маршруты, у которых изменились только расстояния между остановками
+		std::vector<BusId> remeasured_buses;
+		// маршруты, у которых переместились остановки (меняется только длина по координатам)
+		std::vector<BusId> moved_buses;
+		// остановки добавлены, удалены или перемещены
+		bool stops_changed = false;
+
+		bool IsEmpty() const;
+		// меняется ли карта: она зависит только от маршрутов и положения их остановок
+		bool HasMapChanges() const;
+	};
+
+	// класс каталога маршрутов.
+	// Заполнение (AddStop, AddBus, SetDistanceBetweenStops, BuildBusesInfo, BuildStopIndex) выполняется в одном потоке.
+	// После этого каталог меняется только между пакетами запросов (методы изменения и ApplyChanges),
+	// а в остальное время const-методы можно вызывать из любого числа потоков
+	// без блокировок: они только читают данные; возвращаемые указатели и ссылки действительны, пока жив каталог.
+	// Удалённые остановки и маршруты сохраняют свои идентификаторы, новые объекты их не занимают
 	class TransportCatalogue {
 	public:
-		// хешер пары остановок
-		struct StopsHasher {
-			size_t operator()(const std::pair<const Stop*, const Stop*>& two_stops) const;
-		private:
-			std::hash<const void*> hasher_;
-		};
-
-		// добавление остановки
-		void AddStop(std::string name, Coordinates point);
-		// добавление маршрута
-		void AddBus(std::string name, std::vector<const Stop*> stops_of_bus, RouteType loop);
-
-		// поиск остановки по имени
-		const Stop& FindStop(const std::string& name);
-		// поиск маршрута по номеру
-		const Bus& FindBus(const std::string& name);
-		// поиск информации о маршруте по номеру
-		BusInfo GetBusInfo(const std::string& name);
+		// добавление остановки; возвращает её идентификатор (число остановок до неё).
+		// Имя копируется в пул строк каталога
+		StopId AddStop(std::string_view name, Coordinates point);
+		// добавление маршрута по идентификаторам остановок; возвращает идентификатор маршрута
+		BusId AddBus(std::string_view name, std::vector<StopId> stops_of_bus, RouteType loop);
+
+		// доступ по идентификатору (id меньше GetStopCount / GetBusCount, в том числе удалённых)
+		const Stop& GetStop(StopId id) const;
+		const Bus& GetBus(BusId id) const;
+		size_t GetStopCount() const;
+		size_t GetBusCount() const;
+		bool IsStopRemoved(StopId id) const;
+		bool IsBusRemoved(BusId id) const;
+
+		// поиск остановки по имени (nullptr, если остановка не найдена)
+		const Stop* FindStop(std::string_view name) const;
+		// поиск маршрута по номеру (nullptr, если маршрут не найден)
+		const Bus* FindBus(std::string_view name) const;
+		// поиск информации о маршруте по номеру (nullptr, если маршрут не найден);
+		// информация берётся из кэша, заполняемого BuildBusesInfo
+		const BusInfo* GetBusInfo(std::string_view name) const;
+		// подсчет информации обо всех маршрутах (вызывается после заполнения каталога);
+		// с пулом потоков маршруты обрабатываются параллельно
+		void BuildBusesInfo(thread_pool::ThreadPool* pool = nullptr);
+		// построение пространственного индекса остановок (вызывается после заполнения каталога)
+		void BuildStopIndex();
+		// индекс остановок по координатам; пуст до вызова BuildStopIndex
+		const StopIndex& GetStopIndex() const;
 
 		// получение всех маршрутов с их остановками
-		std::unordered_map<std::string_view, std::set<std::string_view>>& GetBusesToStops();
-		// получение информации о дистанции между остановками
-		double GetDistanceBetweenStops(const std::string& stop_name, const std::string& next_stop_name);
-		double GetDistanceBetweenStops(const Stop* stop, const Stop* next_stop) const;
+		const std::unordered_map<std::string_view, std::set<std::string_view>>& GetBusesToStops() const;
+		// получение информации о дистанции между остановками (в обратном направлении, если в прямом она не задана; 0, если не задана)
+		double GetDistanceBetweenStops(std::string_view stop_name, std::string_view next_stop_name) const;
+		double GetDistanceBetweenStops(StopId stop, StopId next_stop) const;
+		// получение всех заданных дистанций между остановками
+		const RoadDistances& GetDistances() const;
 
-		// получение доступа к маршрутам
+		// получение доступа к маршрутам (в порядке номеров, без удалённых)
 		const std::deque<const Bus*> GetBuses() const;
-		// получение доступа к остановкам
+		// получение доступа к остановкам (в порядке идентификаторов, без удалённых)
 		const std::deque<const Stop*> GetStops() const;
-		// получение координат каждой остановки из маршрутов
-		const std::vector<Coordinates> GetAllStopsCoordinates() const;
+		// координаты остановок раздельными массивами широт и долгот (индекс — StopId)
+		const geo::CoordinateArrays& GetStopCoordinates() const;
+
+		// заполнение информации о дистанции между остановками (неизвестные остановки пропускаются)
+		void SetDistanceBetweenStops(std::string_view stop_name, std::string_view next_stop_name, double distance);
+		void SetDistanceBetweenStops(StopId stop, StopId next_stop, double distance);
 
-		// заполнение информации о дистанции между остановками
-		void SetDistanceBetweenStops(std::string stop_name, std::string next_stop_name, double distance);
+		// изменение построенного каталога: затронутые маршруты и остановки запоминаются до ApplyChanges
+		// (новые остановки и маршруты добавляются через AddStop и AddBus)
+		void MoveStop(StopId id, Coordinates point);
+		// удаление остановки; std::invalid_argument, если через неё проходит маршрут
+		void RemoveStop(StopId id);
+		// замена остановок и типа маршрута
+		void SetBusStops(BusId id, std::vector<StopId> stops_of_bus, RouteType loop);
+		void RemoveBus(BusId id);
+		void RemoveDistanceBetweenStops(StopId stop, StopId next_stop);
+		// пересчёт информации о затронутых маршрутах и индекса остановок;
+		// возвращает изменения, чтобы обновить маршрутизатор и карту
+		CatalogueChanges ApplyChanges(thread_pool::ThreadPool* pool = nullptr);
 
 	private:
 		// хранилища:
-		// остановок
+		// имён остановок и маршрутов; на них ссылаются объекты и индексы ниже
+		StringPool names_;
+		// остановок (индекс — StopId); deque не перемещает элементы, поэтому указатели на них стабильны
 		std::deque<Stop> stops_;
-		// маршрутов
+		// широт и долгот остановок (индекс — StopId)
+		geo::CoordinateArrays stop_coordinates_;
+		// координат остановок на единичной сфере (индекс — StopId) для пакетного подсчёта расстояний
+		geo::SpherePoints stop_points_;
+		// маршрутов (индекс — BusId)
 		std::deque<Bus> buses_;
+		// индекс остановок по имени
+		std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
+		// индекс маршрутов по номеру
+		std::unordered_map<std::string_view, const Bus*> busname_to_bus_;
+		// информации о маршрутах по номеру
+		std::unordered_map<std::string_view, BusInfo> busname_to_info_;
 		// маршрутов с их остановками
 		std::unordered_map<std::string_view, std::set<std::string_view>> buses_to_stops_;
 		// информации о дистанции между остановками из маршрутов
-		std::unordered_map<const std::pair<const Stop*, const Stop*>, double, StopsHasher> stop_pair_to_distance_;
+		RoadDistances road_distances_;
+		// остановок по координатам
+		StopIndex stop_index_;
+		// удалённых остановок и маршрутов (индекс — StopId / BusId)
+		std::vector<bool> is_stop_removed_;
+		std::vector<bool> is_bus_removed_;
+		// изменений после BuildBusesInfo; до него изменения не запоминаются
+		bool is_tracking_changes_ = false;
+		CatalogueChanges changes_;
+
+		// информация о маршрутах buses; географические длины перегонов всех маршрутов считаются одним пакетом
+		std::vector<BusInfo> ComputeBusesInfo(const std::vector<const Bus*>& buses, thread_pool::ThreadPool* pool) const;
+		// запоминание маршрутов через остановку stop (и через next_stop, если он задан) в списке изменений buses
+		void AddStopBusesToChanges(StopId stop, std::optional<StopId> next_stop, std::vector<BusId>& buses);
+
+		// подсчет информации о маршруте; segment_lengths — географические длины его перегонов.
+		// У маршрута без остановок все счётчики и длины нулевые
+		BusInfo ComputeBusInfo(const Bus& bus, const double* segment_lengths) const;
 
 		// подсчет коэффициента для работы с маршрутом
-		double GetBusLoopCoeff(Bus& bus);
+		double GetBusLoopCoeff(const Bus& bus) const;
 
 		// подсчет кол-ва остановок
-		size_t GetBusLoopStopNum(Bus& bus);
+		size_t GetBusLoopStopNum(const Bus& bus) const;
 
 		// подсчет количества уникальных остановок
-		size_t GetBusInfoUniqueStops(std::vector<const Stop*> stops_of_bus);
+		size_t GetBusInfoUniqueStops(std::vector<StopId> stops_of_bus) const;
+
+		// количество перегонов маршрута в прямом направлении (для кольцевого — вместе с замыкающим)
+		size_t GetBusSegmentCount(const Bus& bus) const;
+
+		// заполнение начальных и конечных остановок перегонов маршрута
+		void AddBusSegments(const Bus& bus, StopId* from, StopId* to) const;
+
+		// подсчет длины маршрута по координатам
+		double GetBusInfoGeoDistance(const Bus& bus, const double* segment_lengths) const;
 
-		// подсчет длины маршурута 
-		std::pair<double, double> GetBusInfoLoopDistance(Bus& bus, double& looped_coeff);
+		// подсчет фактической длины маршрута
+		double GetBusInfoRealDistance(const Bus& bus, double looped_coeff) const;
 	};
 } // namespace transport_catalogue
\ No newline at end of file
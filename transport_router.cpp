@@ -1,5 +1,7 @@
 #include "transport_router.h"
 
+#include <algorithm>
+
 using namespace transport_router;
 using namespace graph;
 using namespace transport_catalogue;
@@ -18,37 +20,136 @@ bool RouteWeight::operator>(const RouteWeight& other) const {
 }
 
 TransportRouter::TransportRouter(const TransportCatalogue& transport_catalogue,
-    const RouterSettings& route_settings)
+    const RouterSettings& route_settings, thread_pool::ThreadPool* pool)
     : transport_catalogue_(transport_catalogue)
     , route_settings_(route_settings)
 {
-    DirectedWeightedGraph<RouteWeight> graph(SetStopsGetCount());
-    graph_ = std::move(graph);
-    BuildEdges();
-    router_ = std::make_unique<graph::Router<RouteWeight>>(graph_);
+    const std::deque<const Bus*> buses = transport_catalogue_.GetBuses();
+    buses_.assign(buses.begin(), buses.end());
+    BuildGraph(pool);
+    router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, GetRouterMode(), pool);
+}
+
+TransportRouter::TransportRouter(const TransportCatalogue& transport_catalogue, RouterSnapshot snapshot)
+    : transport_catalogue_(transport_catalogue)
+    , route_settings_(std::move(snapshot.settings))
+    , graph_(std::move(snapshot.graph))
+{
+    const std::deque<const Bus*> buses = transport_catalogue_.GetBuses();
+    buses_.assign(buses.begin(), buses.end());
+    stop_count_ = transport_catalogue_.GetStopCount();
+    SetEdgeOffsets();
+    const size_t expected_vertex_count = route_settings_.graph_model == GraphModel::BOARDING
+        ? stop_count_ + GetRideVertexCount()
+        : stop_count_;
+    if (graph_.GetVertexCount() != expected_vertex_count || graph_.GetEdgeCount() != edge_offsets_.back()) {
+        throw std::invalid_argument("Routing graph does not match the catalogue");
+    }
+    if (route_settings_.graph_model == GraphModel::BOARDING) {
+        SetStopVertices();
+    }
+    for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        if (graph_.GetEdgeWeight(edge_id).bus_id >= transport_catalogue_.GetBusCount()) {
+            throw std::invalid_argument("Routing graph does not match the catalogue");
+        }
+    }
+    graph_.Freeze();
+
+    switch (GetRouterMode()) {
+    case RouterMode::PRECOMPUTED:
+        router_ = std::make_unique<Router<RouteWeight>>(graph_, std::move(snapshot.routes_internal_data));
+        break;
+    case RouterMode::CONTRACTION_HIERARCHY:
+        router_ = std::make_unique<Router<RouteWeight>>(graph_, std::make_unique<ContractionHierarchy<RouteWeight>>(
+            graph_, std::move(snapshot.hierarchy_edges), std::move(snapshot.hierarchy_ranks)));
+        break;
+    default:
+        router_ = std::make_unique<Router<RouteWeight>>(graph_, RouterMode::ON_DEMAND);
+        break;
+    }
 }
 
 // построение маршрута
-std::optional<std::vector<RouterEdge>> TransportRouter::BuildRoute(const std::string& from, const std::string& to) {
-    if (from == to) {
+std::optional<std::vector<RouterEdge>> TransportRouter::BuildRoute(std::string_view from, std::string_view to) const {
+    const Stop* stop_from = transport_catalogue_.FindStop(from);
+    const Stop* stop_to = transport_catalogue_.FindStop(to);
+    if (stop_from == nullptr || stop_to == nullptr) {
+        throw std::out_of_range("Unknown stop");
+    }
+    if (stop_from == stop_to) {
         return std::vector<RouterEdge>{};
     }
-
-    size_t from_id = id_by_stop_name_.at(from);
-    size_t to_id = id_by_stop_name_.at(to);
-    std::optional<Router<RouteWeight>::RouteInfo> route = router_->BuildRoute(from_id, to_id);
+    std::optional<Router<RouteWeight>::RouteInfo> route = router_->BuildRoute(GetStopVertex(stop_from->id_), GetStopVertex(stop_to->id_));
 
     if (!route) {
         return std::nullopt;
     }
 
+    if (route_settings_.graph_model == GraphModel::BOARDING) {
+        return MakeBoardingRouteEdges(route->edges);
+    }
+    return MakeRouteEdges(route->edges);
+}
+
+// пешие участки к остановкам и от них становятся весами начальных и конечных вершин поиска;
+// пешком напрямую можно пройти не больше max_walking_distance, как и до остановки
+std::optional<Journey> TransportRouter::BuildRoute(geo::Coordinates from, geo::Coordinates to) const {
+    std::optional<Journey> direct;
+    const double direct_distance = geo::ComputeDistance(from, to);
+    if (direct_distance <= route_settings_.max_walking_distance) {
+        direct.emplace();
+        direct->access.distance = direct_distance;
+        direct->access.total_time = direct_distance / route_settings_.walking_velocity;
+        direct->total_time = direct->access.total_time;
+    }
+
+    const StopIndex& index = transport_catalogue_.GetStopIndex();
+    const std::vector<StopIndex::Neighbour> stops_from = index.FindNearest(from, MAX_WALKING_STOP_COUNT, route_settings_.max_walking_distance);
+    const std::vector<StopIndex::Neighbour> stops_to = index.FindNearest(to, MAX_WALKING_STOP_COUNT, route_settings_.max_walking_distance);
+    if (stops_from.empty() || stops_to.empty()) {
+        return direct;
+    }
+
+    std::optional<TerminalRoute<RouteWeight>> route = router_->BuildRoute(MakeWalkingTerminals(stops_from), MakeWalkingTerminals(stops_to));
+    if (!route || (direct && !(route->weight.total_time < direct->total_time))) {
+        return direct;
+    }
+
+    Journey journey;
+    journey.access = MakeWalkEdge(stops_from, GetVertexStop(route->from));
+    journey.egress = MakeWalkEdge(stops_to, GetVertexStop(route->to));
+    journey.edges = route_settings_.graph_model == GraphModel::BOARDING
+        ? MakeBoardingRouteEdges(route->edges)
+        : MakeRouteEdges(route->edges);
+    journey.total_time = route->weight.total_time;
+    return journey;
+}
+
+std::vector<Terminal<RouteWeight>> TransportRouter::MakeWalkingTerminals(const std::vector<StopIndex::Neighbour>& stops) const {
+    std::vector<Terminal<RouteWeight>> terminals;
+    terminals.reserve(stops.size());
+    for (const StopIndex::Neighbour& stop : stops) {
+        terminals.push_back({ GetStopVertex(stop.stop), RouteWeight{ stop.distance / route_settings_.walking_velocity } });
+    }
+    return terminals;
+}
+
+WalkEdge TransportRouter::MakeWalkEdge(const std::vector<StopIndex::Neighbour>& stops, StopId stop) const {
+    const auto it = std::find_if(stops.begin(), stops.end(), [stop](const StopIndex::Neighbour& neighbour) {
+        return neighbour.stop == stop;
+    });
+    return { transport_catalogue_.GetStop(stop).name_, it->distance, it->distance / route_settings_.walking_velocity };
+}
+
+// преобразование рёбер графа "остановка - остановка" в элементы маршрута
+std::vector<RouterEdge> TransportRouter::MakeRouteEdges(const std::vector<EdgeId>& edges) const {
     std::vector<RouterEdge> result;
-    for (EdgeId edge_id : route->edges) {
+    for (EdgeId edge_id : edges) {
         const Edge<RouteWeight>& edge = graph_.GetEdge(edge_id);
         RouterEdge route_edge;
-        route_edge.bus_name = edge.weight.bus_name;
-        route_edge.stop_name_from = stops_by_id_.at(edge.from)->name_;
-        route_edge.stop_name_to = stops_by_id_.at(edge.to)->name_;
+        route_edge.bus_name = transport_catalogue_.GetBus(edge.weight.bus_id).name_;
+        route_edge.stop_name_from = transport_catalogue_.GetStop(edge.from).name_;
+        route_edge.stop_name_to = transport_catalogue_.GetStop(edge.to).name_;
         route_edge.stop_count = edge.weight.stop_count;
         route_edge.total_time = edge.weight.total_time;
         result.push_back(route_edge);
@@ -56,64 +157,439 @@ std::optional<std::vector<RouterEdge>> TransportRouter::BuildRoute(const std::st
     return result;
 }
 
+// сборка элементов маршрута из цепочек "посадка - перегоны - высадка"
+std::vector<RouterEdge> TransportRouter::MakeBoardingRouteEdges(const std::vector<EdgeId>& edges) const {
+    std::vector<RouterEdge> result;
+    RouterEdge route_edge;
+    for (EdgeId edge_id : edges) {
+        const Edge<RouteWeight>& edge = graph_.GetEdge(edge_id);
+        if (const StopId stop_from = GetVertexStop(edge.from); stop_from != NO_STOP) {
+            // посадка: ожидание автобуса на остановке
+            route_edge = RouterEdge{};
+            route_edge.bus_name = transport_catalogue_.GetBus(edge.weight.bus_id).name_;
+            route_edge.stop_name_from = transport_catalogue_.GetStop(stop_from).name_;
+            route_edge.total_time = edge.weight.total_time;
+        }
+        else if (const StopId stop_to = GetVertexStop(edge.to); stop_to != NO_STOP) {
+            // высадка на остановке
+            route_edge.stop_name_to = transport_catalogue_.GetStop(stop_to).name_;
+            result.push_back(route_edge);
+        }
+        else {
+            // перегон между соседними остановками маршрута
+            route_edge.total_time += edge.weight.total_time;
+            route_edge.stop_count += edge.weight.stop_count;
+        }
+    }
+    return result;
+}
+
+// изменения маршрутов и новые остановки меняют состав рёбер и вершин, изменения расстояний — только веса рёбер;
+// перемещение остановок на графе не сказывается
+void TransportRouter::Update(const CatalogueChanges& changes, thread_pool::ThreadPool* pool) {
+    if (changes.rerouted_buses.empty() && stop_count_ == transport_catalogue_.GetStopCount()) {
+        UpdateEdgeWeights(changes.remeasured_buses, pool);
+        return;
+    }
+
+    const std::vector<const Bus*> old_buses = std::move(buses_);
+    const std::vector<size_t> old_edge_offsets = std::move(edge_offsets_);
+    const std::deque<const Bus*> buses = transport_catalogue_.GetBuses();
+    buses_.assign(buses.begin(), buses.end());
+    if (route_settings_.graph_model == GraphModel::BOARDING) {
+        UpdateBoardingEdges(old_buses, old_edge_offsets, changes, pool);
+        return;
+    }
+    UpdateStopPairsEdges(old_buses, old_edge_offsets, changes, pool);
+}
+
+// веса рёбер маршрутов с изменившимися расстояниями; число и концы рёбер остаются прежними
+void TransportRouter::UpdateEdgeWeights(const std::vector<BusId>& buses, thread_pool::ThreadPool* pool) {
+    std::vector<size_t> positions;
+    positions.reserve(buses.size());
+    for (BusId bus : buses) {
+        const size_t position = FindBusPosition(transport_catalogue_.GetBus(bus));
+        if (position != buses_.size()) {
+            positions.push_back(position);
+        }
+    }
+    std::vector<size_t> offsets(positions.size() + 1, 0);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        offsets[i + 1] = offsets[i] + edge_offsets_[positions[i] + 1] - edge_offsets_[positions[i]];
+    }
+    std::vector<Edge<RouteWeight>> edges(offsets.back());
+    thread_pool::ParallelFor(pool, positions.size(), [this, &positions, &offsets, &edges](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Bus& bus = *buses_[positions[i]];
+            if (offsets[i] == offsets[i + 1]) {
+                continue;
+            }
+            if (route_settings_.graph_model == GraphModel::BOARDING) {
+                // первое ребро маршрута — посадка в его первую вершину поездки
+                AddBoardingBusEdges(bus, graph_.GetEdgeTo(edge_offsets_[positions[i]]), edges.data() + offsets[i]);
+            }
+            else {
+                AddBusEdges(bus, edges.data() + offsets[i]);
+            }
+        }
+    });
+
+    std::vector<EdgeId> changed_edges;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        for (size_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+            const EdgeId edge_id = edge_offsets_[positions[i]] + j - offsets[i];
+            if (graph_.GetEdgeWeight(edge_id).total_time != edges[j].weight.total_time) {
+                graph_.SetEdgeWeight(edge_id, edges[j].weight);
+                changed_edges.push_back(edge_id);
+            }
+        }
+    }
+    if (!changed_edges.empty()) {
+        router_->Update({}, changed_edges, pool);
+    }
+}
+
+// рёбра неизменных маршрутов переносятся из прежнего графа, затронутых — строятся заново;
+// порядок рёбер тот же, что при построении графа с нуля
+void TransportRouter::UpdateStopPairsEdges(const std::vector<const Bus*>& old_buses, const std::vector<size_t>& old_edge_offsets,
+    const CatalogueChanges& changes, thread_pool::ThreadPool* pool) {
+    const size_t bus_count = transport_catalogue_.GetBusCount();
+    std::vector<size_t> old_positions(bus_count, old_buses.size());
+    for (size_t i = 0; i < old_buses.size(); ++i) {
+        old_positions[old_buses[i]->id_] = i;
+    }
+    std::vector<bool> is_changed(bus_count, false);
+    for (const std::vector<BusId>* changed_buses : { &changes.rerouted_buses, &changes.remeasured_buses }) {
+        for (BusId bus : *changed_buses) {
+            is_changed[bus] = true;
+        }
+    }
+
+    SetEdgeOffsets();
+    std::vector<Edge<RouteWeight>> edges(edge_offsets_.back());
+    std::vector<std::optional<EdgeId>> edge_ids(graph_.GetEdgeCount());
+    thread_pool::ParallelFor(pool, buses_.size(), [this, &old_buses, &old_edge_offsets, &old_positions, &is_changed, &edges, &edge_ids](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Bus& bus = *buses_[i];
+            const size_t old_position = old_positions[bus.id_];
+            if (is_changed[bus.id_] || old_position == old_buses.size()) {
+                AddBusEdges(bus, edges.data() + edge_offsets_[i]);
+                continue;
+            }
+            for (EdgeId old_id = old_edge_offsets[old_position]; old_id < old_edge_offsets[old_position + 1]; ++old_id) {
+                const EdgeId edge_id = edge_offsets_[i] + old_id - old_edge_offsets[old_position];
+                edges[edge_id] = graph_.GetEdge(old_id);
+                edge_ids[old_id] = edge_id;
+            }
+        }
+    });
+    std::vector<EdgeId> changed_edges;
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        const size_t old_position = old_positions[buses_[i]->id_];
+        if (is_changed[buses_[i]->id_] || old_position == old_buses.size()) {
+            for (EdgeId edge_id = edge_offsets_[i]; edge_id < edge_offsets_[i + 1]; ++edge_id) {
+                changed_edges.push_back(edge_id);
+            }
+        }
+    }
+
+    stop_count_ = transport_catalogue_.GetStopCount();
+    graph_ = DirectedWeightedGraph<RouteWeight>(stop_count_);
+    AddEdgesToGraph(edges);
+    graph_.Freeze();
+    router_->Update(edge_ids, changed_edges, pool);
+}
+
+// рёбра неизменных маршрутов переносятся из прежнего графа вместе с их вершинами поездки, маршрутам с изменившимися
+// расстояниями рёбра строятся заново на прежних вершинах. Новым остановкам и вершинам поездки новых и перестроенных
+// маршрутов отводятся вершины в конце графа, прежние вершины поездки перестроенных и удалённых маршрутов
+// остаются без рёбер; когда таких вершин становится больше, чем действующих вершин поездки, граф строится заново
+void TransportRouter::UpdateBoardingEdges(const std::vector<const Bus*>& old_buses, const std::vector<size_t>& old_edge_offsets,
+    const CatalogueChanges& changes, thread_pool::ThreadPool* pool) {
+    const size_t bus_count = transport_catalogue_.GetBusCount();
+    std::vector<size_t> old_positions(bus_count, old_buses.size());
+    for (size_t i = 0; i < old_buses.size(); ++i) {
+        old_positions[old_buses[i]->id_] = i;
+    }
+    std::vector<bool> is_rerouted(bus_count, false);
+    for (BusId bus : changes.rerouted_buses) {
+        is_rerouted[bus] = true;
+    }
+    std::vector<bool> is_changed = is_rerouted;
+    for (BusId bus : changes.remeasured_buses) {
+        is_changed[bus] = true;
+    }
+
+    // вершины новых остановок, затем вершины поездки новых и перестроенных маршрутов
+    const size_t stop_count = transport_catalogue_.GetStopCount();
+    VertexId next_vertex = graph_.GetVertexCount();
+    std::vector<VertexId> stop_vertices(stop_count - stop_count_);
+    for (VertexId& vertex : stop_vertices) {
+        vertex = next_vertex++;
+    }
+    SetEdgeOffsets();
+    std::vector<VertexId> ride_vertices(buses_.size());
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        const Bus& bus = *buses_[i];
+        const size_t old_position = old_positions[bus.id_];
+        if (edge_offsets_[i] == edge_offsets_[i + 1]) {
+            continue;
+        }
+        if (is_rerouted[bus.id_] || old_position == old_buses.size()) {
+            ride_vertices[i] = next_vertex;
+            next_vertex += bus.stops_of_bus_.size() * (bus.loop_ == RouteType::NOT_LOOPED ? 2 : 1);
+        }
+        else {
+            // первое ребро маршрута — посадка в его первую вершину поездки
+            ride_vertices[i] = graph_.GetEdgeTo(old_edge_offsets[old_position]);
+        }
+    }
+    // вершин поездки без рёбер больше, чем действующих
+    if (next_vertex - stop_count > 2 * GetRideVertexCount()) {
+        const RouterMode mode = router_->GetMode();
+        BuildGraph(pool);
+        router_ = std::make_unique<graph::Router<RouteWeight>>(graph_, mode, pool);
+        return;
+    }
+    stop_vertices_.insert(stop_vertices_.end(), stop_vertices.begin(), stop_vertices.end());
+    vertex_stops_.resize(next_vertex, NO_STOP);
+    for (StopId stop = stop_count_; stop < stop_count; ++stop) {
+        vertex_stops_[stop_vertices_[stop]] = stop;
+    }
+    stop_count_ = stop_count;
+
+    std::vector<Edge<RouteWeight>> edges(edge_offsets_.back());
+    std::vector<std::optional<EdgeId>> edge_ids(graph_.GetEdgeCount());
+    thread_pool::ParallelFor(pool, buses_.size(), [this, &old_buses, &old_edge_offsets, &old_positions, &is_changed, &ride_vertices, &edges, &edge_ids](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Bus& bus = *buses_[i];
+            const size_t old_position = old_positions[bus.id_];
+            if (is_changed[bus.id_] || old_position == old_buses.size()) {
+                AddBoardingBusEdges(bus, ride_vertices[i], edges.data() + edge_offsets_[i]);
+                continue;
+            }
+            for (EdgeId old_id = old_edge_offsets[old_position]; old_id < old_edge_offsets[old_position + 1]; ++old_id) {
+                const EdgeId edge_id = edge_offsets_[i] + old_id - old_edge_offsets[old_position];
+                edges[edge_id] = graph_.GetEdge(old_id);
+                edge_ids[old_id] = edge_id;
+            }
+        }
+    });
+    std::vector<EdgeId> changed_edges;
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        const size_t old_position = old_positions[buses_[i]->id_];
+        if (is_changed[buses_[i]->id_] || old_position == old_buses.size()) {
+            for (EdgeId edge_id = edge_offsets_[i]; edge_id < edge_offsets_[i + 1]; ++edge_id) {
+                changed_edges.push_back(edge_id);
+            }
+        }
+    }
+
+    graph_ = DirectedWeightedGraph<RouteWeight>(next_vertex);
+    AddEdgesToGraph(edges);
+    graph_.Freeze();
+    router_->Update(edge_ids, changed_edges, pool);
+}
+
 const RouterSettings& TransportRouter::GetSettings() const {
     return route_settings_;
 }
 RouterSettings& TransportRouter::GetSettings() {
     return route_settings_;
 }
+const DirectedWeightedGraph<RouteWeight>& TransportRouter::GetGraph() const {
+    return graph_;
+}
+const Router<RouteWeight>& TransportRouter::GetRouter() const {
+    return *router_;
+}
+
+// количество вершин поездки: по одной на каждую остановку каждого направления маршрута
+size_t TransportRouter::GetRideVertexCount() const {
+    size_t ride_vertex_count = 0;
+    for (const Bus* bus : buses_) {
+        if (bus->stops_of_bus_.size() < 2) {
+            continue;
+        }
+        ride_vertex_count += bus->stops_of_bus_.size() * (bus->loop_ == RouteType::NOT_LOOPED ? 2 : 1);
+    }
+    return ride_vertex_count;
+}
+
+// выбор режима маршрутизатора: явно заданный в настройках или по размеру графа
+RouterMode TransportRouter::GetRouterMode() const {
+    if (route_settings_.router_mode) {
+        return *route_settings_.router_mode;
+    }
+    return graph_.GetVertexCount() <= MAX_PRECOMPUTED_VERTEX_COUNT ? RouterMode::PRECOMPUTED : RouterMode::ON_DEMAND;
+}
 
-// заполнение полей остановками и возвращение их количества
-size_t TransportRouter::SetStopsGetCount() {
-    size_t stops_counter = 0;
-    const std::deque<const Stop*>& stops = transport_catalogue_.GetStops();
-    id_by_stop_name_.reserve(stops.size());
-    stops_by_id_.reserve(stops.size());
-    for (const Stop* stop : stops) {
-        id_by_stop_name_.insert({ stop->name_, stops_counter });
-        stops_by_id_.insert({ stops_counter, stop });
-        ++stops_counter;
+// число рёбер маршрута: k * (k - 1) / 2 на каждое направление из k остановок,
+// в модели BOARDING — 3 * (k - 1) (посадка, перегон и высадка)
+size_t TransportRouter::GetBusEdgeCount(const Bus& bus) const {
+    const size_t stops_count = bus.stops_of_bus_.size();
+    if (stops_count < 2) {
+        return 0;
+    }
+    const size_t directions = bus.loop_ == RouteType::NOT_LOOPED ? 2 : 1;
+    return route_settings_.graph_model == GraphModel::BOARDING
+        ? directions * 3 * (stops_count - 1)
+        : directions * stops_count * (stops_count - 1) / 2;
+}
+
+void TransportRouter::SetEdgeOffsets() {
+    edge_offsets_.assign(buses_.size() + 1, 0);
+    for (size_t i = 0; i < buses_.size(); ++i) {
+        edge_offsets_[i + 1] = edge_offsets_[i] + GetBusEdgeCount(*buses_[i]);
+    }
+}
+
+// вершины остановок модели BOARDING после построения графа — [0, stop_count_), остальные — вершины поездки
+void TransportRouter::SetStopVertices() {
+    stop_vertices_.resize(stop_count_);
+    vertex_stops_.assign(graph_.GetVertexCount(), NO_STOP);
+    for (StopId stop = 0; stop < stop_count_; ++stop) {
+        stop_vertices_[stop] = stop;
+        vertex_stops_[stop] = stop;
+    }
+}
+
+VertexId TransportRouter::GetStopVertex(StopId stop) const {
+    return stop_vertices_.empty() ? stop : stop_vertices_[stop];
+}
+
+StopId TransportRouter::GetVertexStop(VertexId vertex) const {
+    return vertex_stops_.empty() ? static_cast<StopId>(vertex) : vertex_stops_[vertex];
+}
+
+size_t TransportRouter::FindBusPosition(const Bus& bus) const {
+    const auto it = std::lower_bound(buses_.begin(), buses_.end(), bus.name_, [](const Bus* lhs, std::string_view name) {
+        return lhs->name_ < name;
+    });
+    return it != buses_.end() && *it == &bus ? static_cast<size_t>(it - buses_.begin()) : buses_.size();
+}
+
+// построение графа по маршрутам buses_
+void TransportRouter::BuildGraph(thread_pool::ThreadPool* pool) {
+    stop_count_ = transport_catalogue_.GetStopCount();
+    if (route_settings_.graph_model == GraphModel::BOARDING) {
+        graph_ = DirectedWeightedGraph<RouteWeight>(stop_count_ + GetRideVertexCount());
+        SetStopVertices();
+        BuildBoardingEdges(pool);
+    }
+    else {
+        graph_ = DirectedWeightedGraph<RouteWeight>(stop_count_);
+        BuildEdges(pool);
     }
-    return stops_counter;
+    graph_.Freeze();
 }
 
 // построение граней графа
-void TransportRouter::BuildEdges() {
+void TransportRouter::BuildEdges(thread_pool::ThreadPool* pool) {
+    SetEdgeOffsets();
+    std::vector<Edge<RouteWeight>> edges(edge_offsets_.back());
+    thread_pool::ParallelFor(pool, buses_.size(), [this, &edges](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            AddBusEdges(*buses_[i], edges.data() + edge_offsets_[i]);
+        }
+    });
+    AddEdgesToGraph(edges);
+}
+// построение граней одного маршрута
+void TransportRouter::AddBusEdges(const Bus& bus, Edge<RouteWeight>* edges) const {
     const int8_t there = -1, back = 1;
-    for (const Bus* bus : transport_catalogue_.GetBuses()) {
-        size_t stops_count = bus->stops_of_bus_.size();
-        for (size_t i = 0; i < stops_count - 1; ++i) {
-            double time_there, time_back;
-            time_there = time_back = route_settings_.bus_wait_time;
-            for (size_t j = i + 1; j < stops_count; ++j) {
-                AddEdge(bus, there, i, j, time_there);
-                if (bus->loop_ == RouteType::NOT_LOOPED) {
-                    AddEdge(bus, back, stops_count - 1 - i, stops_count - 1 - j, time_back);
-                }
+    size_t stops_count = bus.stops_of_bus_.size();
+    for (size_t i = 0; i + 1 < stops_count; ++i) {
+        double time_there, time_back;
+        time_there = time_back = route_settings_.bus_wait_time;
+        for (size_t j = i + 1; j < stops_count; ++j) {
+            AddEdge(bus, there, i, j, time_there, edges);
+            if (bus.loop_ == RouteType::NOT_LOOPED) {
+                AddEdge(bus, back, stops_count - 1 - i, stops_count - 1 - j, time_back, edges);
             }
         }
     }
 }
-// добавление грани в граф
-void TransportRouter::AddEdge(const Bus* bus, const int8_t direction_factor, const size_t stop, const size_t stop_next, double& total_time) {
+// добавление грани в буфер
+void TransportRouter::AddEdge(const Bus& bus, const int8_t direction_factor, const size_t stop, const size_t stop_next, double& total_time, Edge<RouteWeight>*& edges) const {
     Edge<RouteWeight> edge = MakeEdge(bus, stop, stop_next);
     total_time += ComputeRouteTime(bus, stop_next + direction_factor, stop_next);
     edge.weight.total_time = total_time;
-    graph_.AddEdge(edge);
+    *edges++ = edge;
 }
-// создание грани
-Edge<RouteWeight> TransportRouter::MakeEdge(const Bus* bus, const size_t stop_id_from, const size_t stop_id_to) {
+// создание грани; вершины остановок совпадают с их StopId
+Edge<RouteWeight> TransportRouter::MakeEdge(const Bus& bus, const size_t stop_id_from, const size_t stop_id_to) const {
     Edge<RouteWeight> edge;
-    edge.from = id_by_stop_name_.at(bus->stops_of_bus_.at(stop_id_from)->name_);
-    edge.to = id_by_stop_name_.at(bus->stops_of_bus_.at(stop_id_to)->name_);
-    edge.weight.bus_name = bus->name_;
-    edge.weight.stop_count = stop_id_to - stop_id_from;
+    edge.from = bus.stops_of_bus_[stop_id_from];
+    edge.to = bus.stops_of_bus_[stop_id_to];
+    edge.weight.bus_id = bus.id_;
+    // для обратного направления индексы убывают, число перегонов берём по модулю
+    edge.weight.stop_count = stop_id_to > stop_id_from ? stop_id_to - stop_id_from : stop_id_from - stop_id_to;
     return edge;
 }
 // вычисление времени поездки
-double TransportRouter::ComputeRouteTime(const Bus* bus, const size_t stop_id_from, const size_t stop_id_to) {
+double TransportRouter::ComputeRouteTime(const Bus& bus, const size_t stop_id_from, const size_t stop_id_to) const {
     double distance = transport_catalogue_.GetDistanceBetweenStops(
-        bus->stops_of_bus_.at(stop_id_from), bus->stops_of_bus_.at(stop_id_to)
+        bus.stops_of_bus_[stop_id_from], bus.stops_of_bus_[stop_id_to]
     );
     return distance / route_settings_.bus_velocity;
+}
+
+// построение граней графа с вершинами поездки: остановки занимают вершины [0, stops_count),
+// за ними следуют вершины поездки каждого направления каждого маршрута
+void TransportRouter::BuildBoardingEdges(thread_pool::ThreadPool* pool) {
+    // на направление из k остановок приходится k вершин поездки
+    const size_t bus_count = buses_.size();
+    SetEdgeOffsets();
+    std::vector<VertexId> ride_vertices(bus_count + 1, stop_count_);
+    for (size_t i = 0; i < bus_count; ++i) {
+        const size_t stops_count = buses_[i]->stops_of_bus_.size();
+        const size_t directions = stops_count < 2 ? 0 : buses_[i]->loop_ == RouteType::NOT_LOOPED ? 2 : 1;
+        ride_vertices[i + 1] = ride_vertices[i] + directions * stops_count;
+    }
+    std::vector<Edge<RouteWeight>> edges(edge_offsets_.back());
+    thread_pool::ParallelFor(pool, bus_count, [this, &ride_vertices, &edges](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            AddBoardingBusEdges(*buses_[i], ride_vertices[i], edges.data() + edge_offsets_[i]);
+        }
+    });
+    AddEdgesToGraph(edges);
+}
+// построение граней с вершинами поездки для обоих направлений одного маршрута
+void TransportRouter::AddBoardingBusEdges(const Bus& bus, VertexId ride_vertex, Edge<RouteWeight>* edges) const {
+    size_t stops_count = bus.stops_of_bus_.size();
+    if (stops_count < 2) {
+        return;
+    }
+    std::vector<size_t> stop_indexes(stops_count);
+    for (size_t i = 0; i < stops_count; ++i) {
+        stop_indexes[i] = i;
+    }
+    AddRideEdges(bus, stop_indexes, ride_vertex, edges);
+    if (bus.loop_ == RouteType::NOT_LOOPED) {
+        std::reverse(stop_indexes.begin(), stop_indexes.end());
+        AddRideEdges(bus, stop_indexes, ride_vertex + stops_count, edges);
+    }
+}
+// добавление посадки, перегонов и высадки для одного направления маршрута
+void TransportRouter::AddRideEdges(const Bus& bus, const std::vector<size_t>& stop_indexes, VertexId ride_vertex, Edge<RouteWeight>*& edges) const {
+    const double wait_time = route_settings_.bus_wait_time;
+    for (size_t i = 0; i < stop_indexes.size(); ++i) {
+        const VertexId stop_vertex = GetStopVertex(bus.stops_of_bus_[stop_indexes[i]]);
+        const VertexId current = ride_vertex + i;
+        if (i + 1 < stop_indexes.size()) {
+            *edges++ = { stop_vertex, current, RouteWeight{ wait_time, bus.id_, 0 } };
+            *edges++ = { current, current + 1,
+                RouteWeight{ ComputeRouteTime(bus, stop_indexes[i], stop_indexes[i + 1]), bus.id_, 1 } };
+        }
+        if (i > 0) {
+            *edges++ = { current, stop_vertex, RouteWeight{ 0, bus.id_, 0 } };
+        }
+    }
+}
+// перенос рёбер из буфера в граф в порядке маршрутов
+void TransportRouter::AddEdgesToGraph(const std::vector<Edge<RouteWeight>>& edges) {
+    for (const Edge<RouteWeight>& edge : edges) {
+        graph_.AddEdge(edge);
+    }
 }
\ No newline at end of file
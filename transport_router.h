@@ -4,17 +4,30 @@
 #include "router.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
+#include <limits>
 #include <memory>
 
 namespace transport_router {
+	// способ построения графа маршрутов
+	enum class GraphModel {
+		STOP_PAIRS, // ребро от каждой остановки маршрута до каждой последующей, O(k^2) рёбер на автобус
+		BOARDING    // вершины ожидания на остановках и вершины поездки по маршруту, O(k) рёбер на автобус
+	};
+
 	struct RouterSettings {
 		size_t bus_wait_time = 1; // время ожидания автобуса на остановке, в минутах (целое число от 1 до 1000)
 		float bus_velocity = 1.;  // скорость автобуса, в км/ч (вещественное число от 1 до 1000)
+		std::optional<graph::RouterMode> router_mode; // режим маршрутизатора (если не задан, выбирается по размеру графа)
+		GraphModel graph_model = GraphModel::STOP_PAIRS; // способ построения графа маршрутов
+		float walking_velocity = 5.; // скорость пешехода, в км/ч; используется в маршрутах между точками
+		double max_walking_distance = 1000; // наибольшее расстояние пешком до остановки, от неё или напрямую, в метрах
 	};
 
+	// вес ребра графа; автобус хранится идентификатором BusId каталога
 	struct RouteWeight {
-		std::string_view bus_name;
 		double total_time = 0;
+		domain::BusId bus_id = 0;
 		int stop_count = 0;
 
 		bool operator<(const RouteWeight& other) const;
@@ -30,29 +43,117 @@ namespace transport_router {
 		int stop_count = 0;
 	};
 
+	// пеший участок маршрута между точкой и остановкой
+	struct WalkEdge {
+		std::string_view stop_name; // остановка в конце первого участка или в начале последнего; пустое — пешком напрямую
+		double distance = 0; // в метрах
+		double total_time = 0;
+	};
+
+	// маршрут между точками: пешком до первой остановки, поездки, пешком от последней остановки.
+	// Если дойти пешком напрямую не дольше (и не дальше max_walking_distance), маршрут состоит из одного участка access
+	struct Journey {
+		WalkEdge access;
+		std::vector<RouterEdge> edges;
+		std::optional<WalkEdge> egress;
+		double total_time = 0;
+	};
+
+	// граф и результаты предобработки маршрутизатора, прочитанные из снимка базы
+	struct RouterSnapshot {
+		RouterSettings settings; // router_mode задан явно
+		graph::DirectedWeightedGraph<RouteWeight> graph;
+		graph::Router<RouteWeight>::RoutesInternalData routes_internal_data; // для PRECOMPUTED
+		std::vector<graph::ContractionHierarchy<RouteWeight>::HierarchyEdge> hierarchy_edges; // для CONTRACTION_HIERARCHY
+		std::vector<size_t> hierarchy_ranks; // для CONTRACTION_HIERARCHY
+	};
+
+	// наибольшее число вершин графа, при котором по умолчанию строится таблица всех кратчайших путей
+	inline constexpr size_t MAX_PRECOMPUTED_VERTEX_COUNT = 500;
+	// наибольшее число ближайших остановок, рассматриваемых для начала и конца маршрута между точками
+	inline constexpr size_t MAX_WALKING_STOP_COUNT = 16;
+
+	// граф и маршрутизатор строятся в конструкторе и меняются только в Update:
+	// BuildRoute и другие const-методы можно вызывать из нескольких потоков одновременно,
+	// пока каталог, по которому построен маршрутизатор, не изменяется
 	class TransportRouter {
 	public:
-		TransportRouter(const transport_catalogue::TransportCatalogue& transport_catalogue_, const RouterSettings& route_settings);
+		// с пулом потоков рёбра маршрутов и таблица кратчайших путей строятся параллельно
+		TransportRouter(const transport_catalogue::TransportCatalogue& transport_catalogue_, const RouterSettings& route_settings,
+			thread_pool::ThreadPool* pool = nullptr);
+		// восстановление без построения графа и предобработки; каталог должен совпадать с сохранённым
+		TransportRouter(const transport_catalogue::TransportCatalogue& transport_catalogue_, RouterSnapshot snapshot);
 
-		std::optional<std::vector<RouterEdge>> BuildRoute(const std::string& from, const std::string& to);
+		// остановки задаются именами; std::out_of_range, если остановки нет в каталоге (в том числе удалённой)
+		std::optional<std::vector<RouterEdge>> BuildRoute(std::string_view from, std::string_view to) const;
+		// маршрут между точками через ближайшие к ним остановки (индекс остановок каталога должен быть построен);
+		// все пары начальных и конечных остановок перебираются одним поиском в графе.
+		// std::nullopt, если нет ни маршрута через остановки, ни пешего пути не длиннее max_walking_distance
+		std::optional<Journey> BuildRoute(geo::Coordinates from, geo::Coordinates to) const;
+
+		// учёт изменений каталога (результат TransportCatalogue::ApplyChanges) между пакетами запросов.
+		// Рёбра строятся заново только для затронутых маршрутов, а если изменились лишь расстояния — только их веса;
+		// маршрутизатор пересчитывает только затронутые изменениями пути (graph::Router::Update).
+		// В модели BOARDING новые остановки и вершины поездки новых и перестроенных маршрутов получают вершины в конце графа
+		void Update(const transport_catalogue::CatalogueChanges& changes, thread_pool::ThreadPool* pool = nullptr);
 
 		const RouterSettings& GetSettings() const;
 		RouterSettings& GetSettings();
+		const graph::DirectedWeightedGraph<RouteWeight>& GetGraph() const;
+		const graph::Router<RouteWeight>& GetRouter() const;
 
 	private:
+		static constexpr domain::StopId NO_STOP = std::numeric_limits<domain::StopId>::max();
+
 		const transport_catalogue::TransportCatalogue& transport_catalogue_;
 		RouterSettings route_settings_;
-		std::unordered_map<size_t, const domain::Stop*> stops_by_id_;
-		std::unordered_map<std::string_view, size_t> id_by_stop_name_;
+		// маршруты в порядке номеров: в этом порядке рёбра добавляются в граф
+		std::vector<const domain::Bus*> buses_;
+		// рёбра маршрута buses_[i] — [edge_offsets_[i], edge_offsets_[i + 1])
+		std::vector<size_t> edge_offsets_;
+		// число остановок каталога, учтённых в графе
+		size_t stop_count_ = 0;
+		// модель BOARDING: вершина каждой остановки и остановка каждой вершины (NO_STOP для вершин поездки).
+		// В модели STOP_PAIRS пусты: вершины остановок — их StopId
+		std::vector<graph::VertexId> stop_vertices_;
+		std::vector<domain::StopId> vertex_stops_;
 		graph::DirectedWeightedGraph<RouteWeight> graph_;
 		std::unique_ptr<graph::Router<RouteWeight>> router_;
 
-		size_t SetStopsGetCount();
+		size_t GetRideVertexCount() const;
+		graph::RouterMode GetRouterMode() const;
+		size_t GetBusEdgeCount(const domain::Bus& bus) const;
+		void SetEdgeOffsets();
+		// позиция маршрута в buses_ (buses_.size(), если его там нет)
+		size_t FindBusPosition(const domain::Bus& bus) const;
+		void SetStopVertices();
+		graph::VertexId GetStopVertex(domain::StopId stop) const;
+		// NO_STOP для вершины поездки
+		domain::StopId GetVertexStop(graph::VertexId vertex) const;
+
+		void BuildGraph(thread_pool::ThreadPool* pool);
+		void UpdateEdgeWeights(const std::vector<domain::BusId>& buses, thread_pool::ThreadPool* pool);
+		void UpdateStopPairsEdges(const std::vector<const domain::Bus*>& old_buses, const std::vector<size_t>& old_edge_offsets,
+			const transport_catalogue::CatalogueChanges& changes, thread_pool::ThreadPool* pool);
+		void UpdateBoardingEdges(const std::vector<const domain::Bus*>& old_buses, const std::vector<size_t>& old_edge_offsets,
+			const transport_catalogue::CatalogueChanges& changes, thread_pool::ThreadPool* pool);
+
+		// рёбра маршрутов строятся независимо, каждый маршрут пишет их в свой участок общего буфера;
+		// рёбра добавляются в граф в порядке маршрутов, поэтому граф не зависит от числа потоков
+		void BuildEdges(thread_pool::ThreadPool* pool);
+		void BuildBoardingEdges(thread_pool::ThreadPool* pool);
+		void AddBusEdges(const domain::Bus& bus, graph::Edge<RouteWeight>* edges) const;
+		void AddBoardingBusEdges(const domain::Bus& bus, graph::VertexId ride_vertex, graph::Edge<RouteWeight>* edges) const;
+		void AddRideEdges(const domain::Bus& bus, const std::vector<size_t>& stop_indexes, graph::VertexId ride_vertex, graph::Edge<RouteWeight>*& edges) const;
+		void AddEdge(const domain::Bus& bus, const int8_t direction_factor, const size_t stop, const size_t stop_next, double& total_time, graph::Edge<RouteWeight>*& edges) const;
+		graph::Edge<RouteWeight> MakeEdge(const domain::Bus& bus, const size_t stop_id_from, const size_t stop_id_to) const;
+		double ComputeRouteTime(const domain::Bus& bus, const size_t stop_id_from, const size_t stop_id_to) const;
+		void AddEdgesToGraph(const std::vector<graph::Edge<RouteWeight>>& edges);
 
-		void BuildEdges();
-		void AddEdge(const domain::Bus* bus, const int8_t direction_factor, const size_t stop, const size_t stop_next, double& total_time);
-		graph::Edge<RouteWeight> MakeEdge(const domain::Bus* bus, const size_t stop_id_from, const size_t stop_id_to);
-		double ComputeRouteTime(const domain::Bus* bus, const size_t stop_id_from, const size_t stop_id_to);
+		std::vector<RouterEdge> MakeRouteEdges(const std::vector<graph::EdgeId>& edges) const;
+		std::vector<RouterEdge> MakeBoardingRouteEdges(const std::vector<graph::EdgeId>& edges) const;
+		std::vector<graph::Terminal<RouteWeight>> MakeWalkingTerminals(const std::vector<transport_catalogue::StopIndex::Neighbour>& stops) const;
+		WalkEdge MakeWalkEdge(const std::vector<transport_catalogue::StopIndex::Neighbour>& stops, domain::StopId stop) const;
 
 	};
 } // namespace transport_router
\ No newline at end of file